@@ -6,718 +6,1412 @@
  *  find the closest line segment to a specific point. The program also uses
  *  Exceptions and data templating to keep the program stable and effective.
  *
+ *  The count on the first line of input sizes the in-memory array, which is
+ *  only allocated once the first command that needs it arrives. A session
+ *  that starts with O or M never allocates it, so a large count does not
+ *  have to fit in memory when the segments are kept on disk or in shards,
+ *  and the array is released as soon as its segments have been moved there.
+ *
  *  Created on: Feb 14, 2020
  *      @author Jay Shoumaker
  */
 
-#include <iostream>
+#include "segments.h"
+#include <cstdio>
+#include <string>
+#include <map>
+#include <cstdlib>
+#include <new>
+#ifndef _WIN32
+#include <csignal>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#endif
 using namespace std;
+using namespace geometry;
 
 /**
- *  Finds the square root of a given number.
- *
- * 	@param num The number of which we want to find the square root of.
- * 	@return l The square root of num.
+ *  Largest number of tiles a segment may be copied into. TiledSegments keeps
+ *  a segment crossing more tiles in a tile of its own that every query reads,
+ *  and ShardedSegments copies a segment whose bounding box touches more than
+ *  this many tiles per shard to every shard.
  */
-double squareroot(double num) {
-	double eps = 1e-6;
-	double k = num;
-	double l = 0.0, r, mid;
+const long long MAX_TILES_PER_SEGMENT = 64;
 
-	if (k >= 1) {
-		r = k;
-	}
-	if (k < 1) {
-		r = 1;
-	}
+/**
+ *  Struct that holds a line segment the way it is written to disk by the
+ *  TiledSegments class.
+ */
+struct SegmentRecord {
+	int index;
+	double x1;
+	double y1;
+	double x2;
+	double y2;
+};
 
-	while (l - k / l > eps || l - k / l < -eps) {
-		mid = l + (r - l) / 2;
-		if (mid < k / mid) {
-			l = mid;
-		} else {
-			r = mid;
-		}
-	}
-	return l;
+/**
+ *  Comparison that orders SegmentRecord objects by their smallest x value, so
+ *  every run on disk can be swept from left to right.
+ */
+bool recordBefore(const SegmentRecord& a, const SegmentRecord& b){
+	double first = (a.x1 < a.x2 ? a.x1 : a.x2);
+	double second = (b.x1 < b.x2 ? b.x1 : b.x2);
+	if (first != second)
+		return first < second;
+	return a.index < b.index;
 }
 
 /**
- * 	Function that rounds the input number to two digits.
+ *  Function that finds the largest magnitude of a record's coordinates.
  *
- * 	@param var The number we want to round.
- * 	@return value The input, rounded to two digits.
+ *  @param record The record being measured.
+ *  @return The largest absolute coordinate.
  */
-double round(double num) {
-    double rndnum;
-    double num2 = num * 100;
-    int num3 = (int)num2;
-    double dec3 = num2 - num3;
-    if ((dec3*10) >= 5) {
-        rndnum = ((int)((num)*100))/100.00 + 0.01;
-    } else {
-        rndnum= ((int)((num)*100))/100.00;
-    }
-    return rndnum;
+double largestCoordinate(const SegmentRecord& record){
+	double largest = fabs(record.x1);
+	if (fabs(record.y1) > largest)
+		largest = fabs(record.y1);
+	if (fabs(record.x2) > largest)
+		largest = fabs(record.x2);
+	if (fabs(record.y2) > largest)
+		largest = fabs(record.y2);
+	return largest;
 }
 
-
-
 /**
- * 	Class that is responsible for handling any exception thrown to it.
+ *  Function that finds how far past its ends a segment has to reach along
+ *  its line to cover every segment itIntersects() pairs it with. The
+ *  predicate rounds the meeting point's x value to two digits, so the lines
+ *  really meet up to 0.005 outside the segments' x ranges.
+ *
+ *  @param record The record being measured.
+ *  @return The reach in x, or 0 for a vertical segment, which never
+ *  	intersects anything.
  */
-class Exception{};
-
+double recordReach(const SegmentRecord& record){
+	if (record.x1 == record.x2)
+		return 0;
+	return 0.0101 + 1e-15*(largestCoordinate(record) + 1);
+}
 
 /**
- * 	Class that handles exceptions specifically caused by LineSegment.
+ *  Function that finds the columns of tiles a segment's path passes through,
+ *  after it has been stretched by its reach.
+ *
+ *  @param record The record being placed.
+ *  @param tileSize The width of a square tile.
+ *  @param first, last Set to the first and last column.
  */
-class LineSegmentException: public Exception{};
-
+void recordColumns(const SegmentRecord& record, double tileSize, long long& first, long long& last){
+	double shift = recordReach(record);
+	first = cellOf((record.x1 < record.x2 ? record.x1 : record.x2) - shift, tileSize);
+	last = cellOf((record.x1 > record.x2 ? record.x1 : record.x2) + shift, tileSize);
+}
 
 /**
- * 	Class that handles exceptions specifically caused by Segments.
+ *  Function that finds the rows of tiles a segment's stretched path passes
+ *  through within one column. The y range is padded for rounding, so two
+ *  segments whose paths meet in a column always share a tile there.
+ *
+ *  @param record The record being placed.
+ *  @param tileSize The width of a square tile.
+ *  @param column The column, between the first and last from recordColumns().
+ *  @param low, high Set to the lowest and highest row.
  */
-class SegmentsException: public Exception{};
+void recordRows(const SegmentRecord& record, double tileSize, long long column, long long& low, long long& high){
+	double bottom = (record.y1 < record.y2 ? record.y1 : record.y2);
+	double top = (record.y1 > record.y2 ? record.y1 : record.y2);
+	if (record.x1 != record.x2){
+		double shift = recordReach(record);
+		double slope = (record.y2 - record.y1) / (record.x2 - record.x1);
+		double from = (record.x1 < record.x2 ? record.x1 : record.x2) - shift;
+		double to = (record.x1 > record.x2 ? record.x1 : record.x2) + shift;
+		if (column * tileSize > from)
+			from = column * tileSize;
+		if ((column + 1) * tileSize < to)
+			to = (column + 1) * tileSize;
+		double pad = 1e-9*(largestCoordinate(record) + 1)*(fabs(slope) + 1);
+		double first = record.y1 + slope*(from - record.x1);
+		double second = record.y1 + slope*(to - record.x1);
+		bottom = (first < second ? first : second) - pad;
+		top = (first > second ? first : second) + pad;
+	}
+	low = cellOf(bottom, tileSize);
+	high = cellOf(top, tileSize);
+}
 
 /**
- *  Class prototype for Point.
+ *  Struct that describes where one sorted run of a tile sits on disk.
  */
-template <class DT> class Point;
+struct TileRun {
+	int file;
+	long offset;
+	int records;
+};
 
 /**
- * 	Method prototype for the overloaded << operator for the Point class.
+ *  Struct that describes one spatial tile kept on disk by TiledSegments.
  */
-template <class DT> ostream& operator << (ostream& s, Point<DT>& aPoint);
-
+struct TileInfo {
+	long long tileX;
+	long long tileY;
+	int records;
+	vector<TileRun> runs;
+};
 
 /**
- *  Class prototype for LineSegment.
+ *  Struct that holds one tile loaded into the TiledSegments page cache.
  */
-template <class DT> class LineSegment;
+struct TileSlot {
+	int tile;
+	long long lastUsed;
+	vector<SegmentRecord> records;
+};
 
 /**
- * 	Method prototype for the overloaded << operator for the LineSegment class.
+ *  Class that holds line segments on disk instead of in one array, for sets
+ *  too large to fit in memory. Segments are split into square tiles (a
+ *  segment is copied into every tile its path passes through, and one
+ *  crossing more than MAX_TILES_PER_SEGMENT tiles goes to a single wide tile
+ *  instead). Every flush writes one file holding a sorted run for each tile
+ *  it touches. The files live in a directory of
+ *  their own made under the temporary directory, so several runs of the
+ *  program never share or read back each other's tiles. Queries load tiles on demand
+ *  through a least recently used cache, so at most memoryBudget segments are
+ *  held in memory at once (a single tile larger than the cache is still
+ *  loaded on its own). Once segments have been moved here, main releases its
+ *  in-memory array, so only this budget stays resident.
  */
-template <class DT> ostream& operator << (ostream& s, LineSegment<DT>& LS);
+template <class DT>
+class TiledSegments {
+	protected:
+		double tileSize;
+		int bufferCapacity;
+		int cacheCapacity;
+		string directory;
+		string prefix;
+		vector<TileInfo> tiles;
+		map<pair<long long, long long>, int> tileNumbers;
+		vector< pair<int, SegmentRecord> > pending;
+		vector<TileSlot> cache;
+		int cached;
+		int files;
+		int wide;
+		vector<int> removed;
+		int count;
+		long long clock;
+		long long hits;
+		long long misses;
+		long long evictions;
+		long long runsWritten;
+		long long bytesWritten;
+		long long bytesRead;
+		string fileName(int file);
+		int findTile(long long tileX, long long tileY, bool create);
+		bool isWide(SegmentRecord& record);
+		bool ownsPair(SegmentRecord& a, SegmentRecord& b, int tile);
+		vector<SegmentRecord>& loadTile(int tile);
+		void dropTile(int tile);
+		bool isRemoved(int index);
+		int position(int index);
+		LineSegment<DT> toSegment(SegmentRecord& record);
+		bool checkPair(SegmentRecord& a, SegmentRecord& b, ostream* s);
+		long long visitIntersections(ostream* s);
+	public:
+		TiledSegments(double size, int memoryBudget, string filePrefix);
+		~TiledSegments();
+		void addLineSegment(LineSegment<DT> L);
+		bool removeLineSegment(Point<DT>& one, Point<DT>& two);
+		void flush();
+		vector<int> findAllIntersects(LineSegment<DT>& LS);
+		int findClosestIndex(Point<DT>& aPoint);
+		long long displayAllIntersections(ostream& s);
+		long long countAllIntersections();
+		void displayStatistics(ostream& s);
+		int getSize();
+};
 
 /**
- *  Class prototype for Segments.
+ *  Constructor for the TiledSegments class.
+ *
+ *  @param size The width of a square tile.
+ *  @param memoryBudget The largest number of segments held in memory; half
+ *  	of it buffers new segments and half of it caches loaded tiles.
+ *  @param filePrefix The start of the name of every run file, inside a new
+ *  	uniquely named directory under the temporary directory.
  */
-template <class DT> class Segments;
+template <class DT>
+TiledSegments<DT>::TiledSegments(double size, int memoryBudget, string filePrefix) {
+	if (size <= 0 || memoryBudget < 2)
+		throw SegmentsException();
+	tileSize = size;
+	bufferCapacity = memoryBudget / 2;
+	cacheCapacity = memoryBudget - bufferCapacity;
+#ifndef _WIN32
+	const char* temporary = getenv("TMPDIR");
+	string pattern = string(temporary != NULL && *temporary != '\0' ? temporary : "/tmp") + "/" + filePrefix + "_XXXXXX";
+	vector<char> name(pattern.begin(), pattern.end());
+	name.push_back('\0');
+	if (mkdtemp(name.data()) == NULL)
+		throw SegmentsException();
+	directory = name.data();
+	prefix = directory + "/" + filePrefix;
+#else
+	//There is no mkdtemp here, so the files get a unique name of their own.
+	prefix = string(tmpnam(NULL)) + "_" + filePrefix;
+#endif
+	cached = 0;
+	files = 0;
+	wide = -1;
+	count = 0;
+	clock = 0;
+	hits = 0;
+	misses = 0;
+	evictions = 0;
+	runsWritten = 0;
+	bytesWritten = 0;
+	bytesRead = 0;
+}
 
 /**
- * 	Method prototype for the overloaded << operator for the Segments class.
+ *  Destructor for the TiledSegments class, which deletes every run file and
+ *  the directory holding them.
  */
-template <class DT> ostream& operator << (ostream& s, Segments<DT>& seg);
-
+template <class DT>
+TiledSegments<DT>::~TiledSegments() {
+	for (int i = 0; i < files; i++)
+		remove(fileName(i).c_str());
+#ifndef _WIN32
+	rmdir(directory.c_str());
+#endif
+}
 
 /**
- * 	Class that holds two doubles as a point along an x/y plane.
+ *  Method that returns the name of the file written by one flush.
+ *
+ *  @param file The number of the file.
+ *  @return The file name.
  */
 template <class DT>
-class Point {
-	friend ostream& operator << <DT>(ostream& s, Point<DT>& aPoint);
-protected:
-	double x;
-	double y;
-public:
-	Point();
-	Point(double xVal, double yVal);
-	void setLocation(double xVal, double yVal);
-	double getXValue();
-	double getYValue();
-	void display();
-	bool operator == (Point<DT>& P);
-
-};
+string TiledSegments<DT>::fileName(int file){
+	return prefix + "_" + to_string(file) + ".run";
+}
 
 /**
- * 	Overloaded << operator for the Point class.
+ *  Method that finds the number of the tile at a given tile position.
+ *
+ *  @param tileX, tileY The position of the tile on the tile grid.
+ *  @param create Whether a missing tile should be created.
+ *  @return The number of the tile, or -1 if it does not exist.
  */
 template <class DT>
-ostream& operator<<(ostream& s, Point<DT>& aPoint){
-	s << "(" << round(aPoint.x) << ", " << round(aPoint.y) << ")";
-	return s;
+int TiledSegments<DT>::findTile(long long tileX, long long tileY, bool create){
+	map<pair<long long, long long>, int>::iterator found = tileNumbers.find(make_pair(tileX, tileY));
+	if (found != tileNumbers.end())
+		return found->second;
+	if (!create)
+		return -1;
+	TileInfo info = {tileX, tileY, 0, vector<TileRun>()};
+	tiles.push_back(info);
+	tileNumbers[make_pair(tileX, tileY)] = tiles.size() - 1;
+	return tiles.size() - 1;
 }
 
 /**
- *  Overloaded == operator for the Point class.
+ *  Method that returns the segments of a tile, reading the tile from disk
+ *  (and evicting the least recently used tiles) if it is not cached.
+ *
+ *  @param tile The number of the tile.
+ *  @return The segments in the tile, sorted by their smallest x value. The
+ *  	reference is only valid until the next call to loadTile().
  */
 template <class DT>
-bool Point<DT>::operator == (Point<DT>& P){
-	return ((x == P.x) && (y == P.y));
+vector<SegmentRecord>& TiledSegments<DT>::loadTile(int tile){
+	clock++;
+	for (int i = 0; i < (int)cache.size(); i++){
+		if (cache[i].tile == tile){
+			hits++;
+			cache[i].lastUsed = clock;
+			return cache[i].records;
+		}
+	}
+	misses++;
+	while (!cache.empty() && cached + tiles[tile].records > cacheCapacity){
+		int oldest = 0;
+		for (int i = 1; i < (int)cache.size(); i++){
+			if (cache[i].lastUsed < cache[oldest].lastUsed)
+				oldest = i;
+		}
+		cached -= cache[oldest].records.size();
+		cache.erase(cache.begin() + oldest);
+		evictions++;
+	}
+
+	TileSlot slot;
+	slot.tile = tile;
+	slot.lastUsed = clock;
+	slot.records.resize(tiles[tile].records);
+	int done = 0;
+	for (int r = 0; r < (int)tiles[tile].runs.size(); r++){
+		TileRun& run = tiles[tile].runs[r];
+		FILE* file = fopen(fileName(run.file).c_str(), "rb");
+		if (file == NULL)
+			throw SegmentsException();
+		size_t read = 0;
+		if (fseek(file, run.offset, SEEK_SET) == 0)
+			read = fread(slot.records.data() + done, sizeof(SegmentRecord), run.records, file);
+		fclose(file);
+		if ((int)read != run.records)
+			throw SegmentsException();
+		bytesRead += read * sizeof(SegmentRecord);
+		done += read;
+	}
+	//Each run is already sorted, so this only has to merge them.
+	if (tiles[tile].runs.size() > 1)
+		stable_sort(slot.records.begin(), slot.records.end(), recordBefore);
+	cached += slot.records.size();
+	cache.push_back(slot);
+	return cache.back().records;
 }
 
 /**
- *  Default constructor for the Point class.
+ *  Method that removes a tile from the cache, so it is read again the next
+ *  time it is needed.
+ *
+ *  @param tile The number of the tile.
  */
 template <class DT>
-Point<DT>::Point() {
-	x = 0.0;
-	y = 0.0;
+void TiledSegments<DT>::dropTile(int tile){
+	for (int i = 0; i < (int)cache.size(); i++){
+		if (cache[i].tile == tile){
+			cached -= cache[i].records.size();
+			cache.erase(cache.begin() + i);
+			return;
+		}
+	}
 }
 
 /**
- *  Constructor for the Point class.
+ *  Method that checks whether a segment has been removed.
  *
- *  @param xVal, yVal The coordinates of the new Point object.
+ *  @param index The index the segment was added with.
+ *  @return Whether the segment was removed.
  */
 template <class DT>
-Point<DT>::Point(double xVal, double yVal) {
-	x = xVal;
-	y = yVal;
+bool TiledSegments<DT>::isRemoved(int index){
+	return binary_search(removed.begin(), removed.end(), index);
 }
 
 /**
- *  Modifier for a Point's x & y variables.
+ *  Method that finds where a segment would sit in an in-memory Segments
+ *  array, after every segment removed before it has been shifted out.
  *
- * 	@param xVal, yVal The new coordinates of a Point Object.
+ *  @param index The index the segment was added with.
+ *  @return The position of the segment.
  */
 template <class DT>
-void Point<DT>::setLocation(double xVal, double yVal) {
-	x = xVal;
-	y = yVal;
+int TiledSegments<DT>::position(int index){
+	return index - (lower_bound(removed.begin(), removed.end(), index) - removed.begin());
 }
 
 /**
- * 	Method that returns the X value of a Point.
+ *  Method that turns a record back into a line segment.
  *
- * 	@return x The x coordinate of a Point.
+ *  @param record The record read from disk.
+ *  @return The line segment it holds.
  */
 template <class DT>
-double Point<DT>::getXValue() {
-	return x;
+LineSegment<DT> TiledSegments<DT>::toSegment(SegmentRecord& record){
+	return LineSegment<DT>(Point<DT>(record.x1, record.y1), Point<DT>(record.x2, record.y2));
 }
 
 /**
- * 	Method that returns the Y value of a Point.
+ *  Method that checks whether a segment's path passes through more than
+ *  MAX_TILES_PER_SEGMENT tiles, or has coordinates too large for
+ *  itIntersects() to place it, so it belongs in the wide tile.
  *
- * 	@return y The Y coordinate of a Point.
+ *  @param record The record being placed.
+ *  @return Whether the segment is wide.
  */
 template <class DT>
-double Point<DT>::getYValue() {
-	return y;
+bool TiledSegments<DT>::isWide(SegmentRecord& record){
+	if (!(largestCoordinate(record) <= 1e7))
+		return true;
+	long long first, last;
+	recordColumns(record, tileSize, first, last);
+	if (last - first + 1 > MAX_TILES_PER_SEGMENT)
+		return true;
+	long long crossed = 0;
+	for (long long column = first; column <= last; column++){
+		long long low, high;
+		recordRows(record, tileSize, column, low, high);
+		crossed += high - low + 1;
+		if (crossed > MAX_TILES_PER_SEGMENT)
+			return true;
+	}
+	return false;
 }
 
 /**
- * 	Method that displays the Point in it's normal form
- * 	e.g. (0, 4), (-12.4, 32.39), (x, y)
+ *  Method that adds a line segment to every tile its path passes through, or
+ *  to the wide tile. The copies are buffered and written to disk once the
+ *  buffer is full.
+ *
+ *  @param L The line segment to be added.
  */
 template <class DT>
-void Point<DT>::display() {
-	cout << "(" << round(x) << ", " << round(y) << ")";
+void TiledSegments<DT>::addLineSegment(LineSegment<DT> L){
+	SegmentRecord record = {count, L.getP1().getXValue(), L.getP1().getYValue(), L.getP2().getXValue(), L.getP2().getYValue()};
+	count++;
+	if (isWide(record)){
+		if (wide < 0){
+			TileInfo info = {0, 0, 0, vector<TileRun>()};
+			tiles.push_back(info);
+			wide = tiles.size() - 1;
+		}
+		pending.push_back(make_pair(wide, record));
+		if ((int)pending.size() >= bufferCapacity)
+			flush();
+		return;
+	}
+	long long first, last;
+	recordColumns(record, tileSize, first, last);
+	for (long long tx = first; tx <= last; tx++){
+		long long low, high;
+		recordRows(record, tileSize, tx, low, high);
+		for (long long ty = low; ty <= high; ty++){
+			pending.push_back(make_pair(findTile(tx, ty, true), record));
+			if ((int)pending.size() >= bufferCapacity)
+				flush();
+		}
+	}
 }
 
-
 /**
- * 	Class that holds a line segment consisting of two points along an x/y plane.
+ *  Method that removes the first line segment with the given end points. The
+ *  segment is only marked as removed; its copies stay on disk.
+ *
+ *  @param one, two The end points of the segment to remove.
+ *  @return Whether a matching segment was found.
  */
 template <class DT>
-class LineSegment {
-protected:
-	Point<DT> P1;
-	Point<DT> P2;
-public:
-	LineSegment();
-	LineSegment(Point<DT> one, Point<DT> two);
-	double length();
-	Point<DT> midpoint();
-	Point<DT> xIntercept();
-	Point<DT> yIntercept();
-	double slope();
-	bool itIntersects(LineSegment L);
-	Point<DT> intersectionPoint(LineSegment L);
-	bool isParallel(LineSegment L);
-	void displayEquation();
-	Point<DT> getP1();
-	Point<DT> getP2();
-	friend ostream& operator << <DT>(ostream& s, LineSegment<DT>& LS);
-};
+bool TiledSegments<DT>::removeLineSegment(Point<DT>& one, Point<DT>& two){
+	flush();
+	//Every segment starting at one was copied into the tile holding one,
+	//unless it went to the wide tile.
+	int candidates[2] = {findTile(cellOf(one.getXValue(), tileSize), cellOf(one.getYValue(), tileSize), false), wide};
+	int first = -1;
+	for (int c = 0; c < 2; c++){
+		if (candidates[c] < 0)
+			continue;
+		vector<SegmentRecord>& records = loadTile(candidates[c]);
+		for (int i = 0; i < (int)records.size(); i++){
+			if (records[i].x1 == one.getXValue() && records[i].y1 == one.getYValue()
+					&& records[i].x2 == two.getXValue() && records[i].y2 == two.getYValue()
+					&& !isRemoved(records[i].index) && (first < 0 || records[i].index < first))
+				first = records[i].index;
+		}
+	}
+	if (first < 0)
+		return false;
+	removed.insert(lower_bound(removed.begin(), removed.end(), first), first);
+	return true;
+}
 
 /**
- * 	Overloaded << operator for the LineSegment class.
+ *  Method that writes every buffered segment to disk. The buffer is sorted by
+ *  tile and then by smallest x value, and written to one new file in which
+ *  each tile's share is a sorted run whose place is kept with the tile.
  */
 template <class DT>
-ostream& operator << (ostream& s, LineSegment<DT>& LS){
-	s << "y=" << round(LS.slope()) << "*x+" << round(LS.yIntercept().getYValue());
-	return s;
+void TiledSegments<DT>::flush(){
+	if (pending.empty())
+		return;
+	stable_sort(pending.begin(), pending.end(),
+			[](const pair<int, SegmentRecord>& a, const pair<int, SegmentRecord>& b){
+		if (a.first != b.first)
+			return a.first < b.first;
+		return recordBefore(a.second, b.second);
+	});
+	FILE* file = fopen(fileName(files).c_str(), "wb");
+	if (file == NULL)
+		throw SegmentsException();
+	files++;
+	vector<SegmentRecord> run;
+	long offset = 0;
+	for (int start = 0; start < (int)pending.size();){
+		int tile = pending[start].first;
+		int end = start;
+		run.clear();
+		while (end < (int)pending.size() && pending[end].first == tile){
+			run.push_back(pending[end].second);
+			end++;
+		}
+		size_t written = fwrite(run.data(), sizeof(SegmentRecord), run.size(), file);
+		if (written != run.size()){
+			fclose(file);
+			throw SegmentsException();
+		}
+		bytesWritten += written * sizeof(SegmentRecord);
+		TileRun placed = {files - 1, offset, (int)run.size()};
+		tiles[tile].runs.push_back(placed);
+		tiles[tile].records += run.size();
+		offset += written * sizeof(SegmentRecord);
+		runsWritten++;
+		dropTile(tile);
+		start = end;
+	}
+	if (fclose(file) != 0)
+		throw SegmentsException();
+	pending.clear();
 }
 
 /**
- * 	Default constructor for the LineSegment class.
+ *  Method that finds all lines that intersect with a given LineSegment, only
+ *  loading the tiles that the segment's path passes through and the wide
+ *  tile. A wide query has to load every tile.
+ *
+ *  @param LS The line segment used to find the intersects.
+ *  @return found The positions of the intersecting segments, in order.
  */
 template <class DT>
-LineSegment<DT>::LineSegment() {
-	P1 = Point<DT>(0, 0);
-	P2 = Point<DT>(0, 0);
+vector<int> TiledSegments<DT>::findAllIntersects(LineSegment<DT>& LS){
+	flush();
+	SegmentRecord query = {-1, LS.getP1().getXValue(), LS.getP1().getYValue(), LS.getP2().getXValue(), LS.getP2().getYValue()};
+	vector<int> visit;
+	if (isWide(query)){
+		for (int t = 0; t < (int)tiles.size(); t++)
+			visit.push_back(t);
+	} else {
+		long long first, last;
+		recordColumns(query, tileSize, first, last);
+		for (long long tx = first; tx <= last; tx++){
+			long long low, high;
+			recordRows(query, tileSize, tx, low, high);
+			for (long long ty = low; ty <= high; ty++){
+				int tile = findTile(tx, ty, false);
+				if (tile >= 0)
+					visit.push_back(tile);
+			}
+		}
+		if (wide >= 0)
+			visit.push_back(wide);
+	}
+	vector<int> found;
+	for (int v = 0; v < (int)visit.size(); v++){
+		vector<SegmentRecord>& records = loadTile(visit[v]);
+		for (int i = 0; i < (int)records.size(); i++){
+			if (isRemoved(records[i].index))
+				continue;
+			LineSegment<DT> segment = toSegment(records[i]);
+			if (segment.isParallel(LS) == false && segment.itIntersects(LS) == true)
+				found.push_back(records[i].index);
+		}
+	}
+	sort(found.begin(), found.end());
+	found.erase(unique(found.begin(), found.end()), found.end());
+	for (int i = 0; i < (int)found.size(); i++)
+		found[i] = position(found[i]);
+	return found;
 }
 
 /**
- * 	Constructor for the LineSegment class.
+ *  Method that finds the index of the closest line segment to a point. Since
+ *  distance() measures to the whole line, every tile has to be checked.
  *
- * 	@param one, two Points that make up the line segment.
+ *  @param aPoint The point being used to find the closest line.
+ *  @return The position of the closest line to aPoint, or -1 when there are
+ *  no line segments.
  */
 template <class DT>
-LineSegment<DT>::LineSegment(Point<DT> one, Point<DT> two) {
-	P1 = one;
-	P2 = two;
+int TiledSegments<DT>::findClosestIndex(Point<DT>& aPoint){
+	flush();
+	double shortest = 1.79769e+308;
+	int line = -1;
+	for (int t = 0; t < (int)tiles.size(); t++){
+		vector<SegmentRecord>& records = loadTile(t);
+		for (int i = 0; i < (int)records.size(); i++){
+			if (isRemoved(records[i].index))
+				continue;
+			double distanceFrom = distance(aPoint, toSegment(records[i]));
+			if (distanceFrom < shortest || (distanceFrom == shortest && records[i].index < line)){
+				shortest = distanceFrom;
+				line = records[i].index;
+			}
+		}
+	}
+	if (line < 0)
+		return -1;
+	return position(line);
 }
 
 /**
- * 	Method that finds the length of a line segment.
+ *  Method that checks whether a pair of segments sharing a tile is reported
+ *  by that tile: the first tile, by column and then by row, that both
+ *  segments' paths pass through. Two segments itIntersects() pairs up always
+ *  share a tile, so every pair is reported once.
  *
- * 	@return length The length of the object.
+ *  @param a, b The records of the two segments, neither of them wide.
+ *  @param tile The number of the tile holding both.
+ *  @return Whether the pair belongs to the tile.
  */
 template <class DT>
-double LineSegment<DT>::length() {
-	double length = 0.0;
-	length = squareroot(((P2.getXValue() - P1.getXValue()) * (P2.getXValue() - P1.getXValue())) + ((P2.getYValue() - P1.getYValue()) * (P2.getYValue() - P1.getYValue())));
-	return length;
+bool TiledSegments<DT>::ownsPair(SegmentRecord& a, SegmentRecord& b, int tile){
+	long long firstA, lastA, firstB, lastB;
+	recordColumns(a, tileSize, firstA, lastA);
+	recordColumns(b, tileSize, firstB, lastB);
+	for (long long column = (firstA > firstB ? firstA : firstB); column <= tiles[tile].tileX && column <= lastA && column <= lastB; column++){
+		long long lowA, highA, lowB, highB;
+		recordRows(a, tileSize, column, lowA, highA);
+		recordRows(b, tileSize, column, lowB, highB);
+		long long low = (lowA > lowB ? lowA : lowB);
+		if (low <= (highA < highB ? highA : highB))
+			return column == tiles[tile].tileX && low == tiles[tile].tileY;
+	}
+	return false;
 }
 
 /**
- *  Method that finds the midpoint of a line segment.
+ *  Method that checks whether two segments intersect and, if a stream is
+ *  given, displays them by their positions. The point is worked out from the
+ *  earlier segment, as the in-memory display does.
  *
- *  @return mid The point at the middle of the line segment.
+ *  @param a, b The records of the two segments.
+ *  @param s The stream the pair is written to, or NULL to only check it.
+ *  @return Whether the segments intersect.
  */
 template <class DT>
-Point<DT> LineSegment<DT>::midpoint() {
-	Point<DT> mid;
-	mid = Point<DT>(round((P1.getXValue() + P2.getXValue()) / 2), round((P1.getYValue() + P2.getYValue()) / 2));
-	return mid;
+bool TiledSegments<DT>::checkPair(SegmentRecord& a, SegmentRecord& b, ostream* s){
+	LineSegment<DT> first = toSegment(a.index < b.index ? a : b);
+	LineSegment<DT> second = toSegment(a.index < b.index ? b : a);
+	if (first.isParallel(second) == true || first.itIntersects(second) == false)
+		return false;
+	if (s != NULL){
+		int i = position(a.index), j = position(b.index);
+		Point<DT> P = first.intersectionPoint(second);
+		*s << "Line segment " << ((i < j ? i : j)+1) << " and Line segment " << ((i < j ? j : i)+1)
+		<< ": Intersection Point :" << P << endl;
+	}
+	return true;
 }
 
 /**
- * 	Method that finds the x-intercept of a line segment. The method assumes that the point
- * 	is a part of a whole line in order to find the intercept, rather than just the segment itself.
+ *  Method that finds every pair of intersecting line segments, one tile at a
+ *  time. A pair of ordinary segments is only reported by the tile ownsPair()
+ *  picks. The wide tile is read once and held while the other tiles are
+ *  visited; a wide segment is paired with an ordinary one in the first tile
+ *  of the ordinary segment's path.
  *
- * 	@return xInt The x-intercept of the line.
+ *  @param s The stream the pairs are written to, or NULL to only count them.
+ *  @return total The number of intersecting pairs.
  */
 template <class DT>
-Point<DT> LineSegment<DT>::xIntercept() {
-	Point<DT> xInt;
-	double slope = this->slope();
-	double x = 0.0;
-	x = -((this->yIntercept().getYValue())/slope);
-	xInt = Point<DT>(x, 0);
-	return xInt;
+long long TiledSegments<DT>::visitIntersections(ostream* s){
+	flush();
+	long long total = 0;
+	vector<SegmentRecord> wideRecords;
+	if (wide >= 0)
+		wideRecords = loadTile(wide);
+	for (int a = 0; a < (int)wideRecords.size(); a++){
+		if (isRemoved(wideRecords[a].index))
+			continue;
+		double rightA = (wideRecords[a].x1 > wideRecords[a].x2 ? wideRecords[a].x1 : wideRecords[a].x2);
+		for (int b = a + 1; b < (int)wideRecords.size(); b++){
+			double leftB = (wideRecords[b].x1 < wideRecords[b].x2 ? wideRecords[b].x1 : wideRecords[b].x2);
+			if (leftB > rightA)
+				break;
+			if (!isRemoved(wideRecords[b].index) && checkPair(wideRecords[a], wideRecords[b], s))
+				total++;
+		}
+	}
+	for (int t = 0; t < (int)tiles.size(); t++){
+		if (t == wide)
+			continue;
+		vector<SegmentRecord>& records = loadTile(t);
+		for (int a = 0; a < (int)records.size(); a++){
+			if (isRemoved(records[a].index))
+				continue;
+			double leftA = (records[a].x1 < records[a].x2 ? records[a].x1 : records[a].x2);
+			double rightA = (records[a].x1 > records[a].x2 ? records[a].x1 : records[a].x2);
+			for (int b = a + 1; b < (int)records.size(); b++){
+				double leftB = (records[b].x1 < records[b].x2 ? records[b].x1 : records[b].x2);
+				if (leftB > rightA)
+					break;
+				if (isRemoved(records[b].index) || !checkPair(records[a], records[b], NULL))
+					continue;
+				if (!ownsPair(records[a], records[b], t))
+					continue;
+				checkPair(records[a], records[b], s);
+				total++;
+			}
+			if (wideRecords.empty())
+				continue;
+			long long first, last, low, high;
+			recordColumns(records[a], tileSize, first, last);
+			recordRows(records[a], tileSize, first, low, high);
+			if (first != tiles[t].tileX || low != tiles[t].tileY)
+				continue;
+			for (int w = 0; w < (int)wideRecords.size(); w++){
+				double leftW = (wideRecords[w].x1 < wideRecords[w].x2 ? wideRecords[w].x1 : wideRecords[w].x2);
+				double rightW = (wideRecords[w].x1 > wideRecords[w].x2 ? wideRecords[w].x1 : wideRecords[w].x2);
+				if (leftW > rightA)
+					break;
+				if (rightW >= leftA && !isRemoved(wideRecords[w].index) && checkPair(records[a], wideRecords[w], s))
+					total++;
+			}
+		}
+	}
+	return total;
 }
 
 /**
- * 	Method that finds the y-intercept of a line segment. The method assumes that the point
- * 	is a part of a whole line in order to find the intercept, rather than just the segment itself.
+ *  Method that displays every pair of intersecting line segments.
  *
- * 	@return yInt The y-intercept of the line.
+ *  @param s The stream the pairs are written to.
+ *  @return The number of intersecting pairs.
  */
 template <class DT>
-Point<DT> LineSegment<DT>::yIntercept() {
-	Point<DT> yInt;
-	double slope = this->slope();
-	double y = 0.0;
-	y = P1.getYValue() - (slope)*P1.getXValue();
-	yInt = Point<DT>(0, y);
-	return yInt;
+long long TiledSegments<DT>::displayAllIntersections(ostream& s){
+	return visitIntersections(&s);
 }
 
 /**
- * 	Method that finds the slope of a line segment.
+ *  Method that counts the pairs of intersecting line segments without
+ *  displaying them.
  *
- * 	@return slope The slope of the line.
+ *  @return The number of intersecting pairs.
  */
 template <class DT>
-double LineSegment<DT>::slope() {
-	double slope = 0.0;
-	slope = ((P2.getYValue() - P1.getYValue()) / (P2.getXValue() - P1.getXValue()));
-	return slope;
+long long TiledSegments<DT>::countAllIntersections(){
+	return visitIntersections(NULL);
 }
 
 /**
- * 	Method that determines whether two line segments intersect or not.
+ *  Method that displays how much disk traffic and caching the queries caused.
  *
- * 	@param L The line segment that is currently being compared to.
- * 	@return intersect The status of whether the lines are intersected or not.
+ *  @param s The stream the statistics are written to.
  */
 template <class DT>
-bool LineSegment<DT>::itIntersects(LineSegment L) {
-	bool intersect = false;
-	if (this->slope() != L.slope()){
-		Point<DT> potentialIntersect = intersectionPoint(L);
-		double first = this->P1.getXValue();
-		double second = this->P2.getXValue();
-		double third = L.P1.getXValue();
-		double fourth = L.P2.getXValue();
-		double potential = potentialIntersect.getXValue();
-		if (first > second){
-			first = this->P2.getXValue();
-			second = this->P1.getXValue();
-		}
-		if (third > fourth){
-			third = L.P2.getXValue();
-			fourth = L.P1.getXValue();
-		}
-		if (first <= potential && potential <= second && third <= potential && potential <= fourth){
-			intersect = true;
-		}
-	}
-	return intersect;
+void TiledSegments<DT>::displayStatistics(ostream& s){
+	long long onDisk = 0;
+	for (int t = 0; t < (int)tiles.size(); t++)
+		onDisk += tiles[t].records;
+	s << "Tiles:" << tiles.size() << endl
+	<< "Segments:" << getSize() << endl
+	<< "Records on disk:" << onDisk << endl
+	<< "Runs written:" << runsWritten << endl
+	<< "Bytes written:" << bytesWritten << endl
+	<< "Bytes read:" << bytesRead << endl
+	<< "Cache hits:" << hits << endl
+	<< "Cache misses:" << misses << endl
+	<< "Cache evictions:" << evictions << endl;
 }
 
 /**
- * 	Method that finds the intersection of two line segments.
+ *  Method that returns the number of segments that have not been removed.
  *
- * 	@param L the line segment that is being used (along with the current line).
- * 	@return intersection The point at which the two segments intersect.
+ *  @return The number of segments held.
  */
 template <class DT>
-Point<DT> LineSegment<DT>::intersectionPoint(LineSegment L) {
-	Point<DT> intersection;
-	double x = round((L.yIntercept().getYValue() - this->yIntercept().getYValue())/(this->slope() - L.slope()));
-	double y = round(((this->yIntercept().getYValue()*L.slope())-(L.yIntercept().getYValue()*this->slope()))/(L.slope() - this->slope()));
-	intersection = Point<DT>(x, y);
-	return intersection;
+int TiledSegments<DT>::getSize(){
+	return count - removed.size();
 }
 
 /**
- * 	Determines whether two line segments are parallel based on their slopes.
+ *  Struct that holds one request sent from the coordinator to a shard.
+ */
+struct ShardRequest {
+	char command;
+	int index;
+	int k;
+	double x1;
+	double y1;
+	double x2;
+	double y2;
+};
+
+/**
+ *  Struct that holds one of the nearest segments a shard sends back.
+ */
+struct ShardNeighbour {
+	double distance;
+	int index;
+};
+
+/**
+ *  Comparison that orders ShardNeighbour objects from nearest to furthest,
+ *  with ties going to the earlier segment.
+ */
+bool operator < (const ShardNeighbour& a, const ShardNeighbour& b){
+	if (a.distance != b.distance)
+		return a.distance < b.distance;
+	return a.index < b.index;
+}
+
+/**
+ *  Struct that holds one intersecting pair a shard sends back, by the
+ *  indices the segments were added with, and where they meet.
+ */
+struct ShardPair {
+	int first;
+	int second;
+	double x;
+	double y;
+};
+
+/**
+ *  Comparison that orders ShardPair objects by their first segment and then
+ *  by their second.
+ */
+bool operator < (const ShardPair& a, const ShardPair& b){
+	if (a.first != b.first)
+		return a.first < b.first;
+	return a.second < b.second;
+}
+
+/**
+ *  Function that writes a whole block of bytes to a socket.
  *
- * 	@param L The line segment that is currently being compared to.
- * 	@return parallel The status of whether the lines are parallel or not.
+ *  @param socket The socket being written to.
+ *  @param data, size The bytes to write.
  */
-template <class DT>
-bool LineSegment<DT>::isParallel(LineSegment L) {
-	bool parallel = false;
-	if (this->slope() == L.slope())
-		parallel = true;
-	return parallel;
+void sendAll(int socket, const void* data, size_t size){
+#ifndef _WIN32
+	const char* next = (const char*)data;
+	while (size > 0){
+		ssize_t sent = write(socket, next, size);
+		if (sent <= 0)
+			throw SegmentsException();
+		next += sent;
+		size -= sent;
+	}
+#else
+	throw SegmentsException();
+#endif
 }
 
 /**
- *  Displays the line's formula as an equation in y=mx+c form.
- *  e.g. y=1.4x+5, y=-6x+-2
+ *  Function that reads a whole block of bytes from a socket.
+ *
+ *  @param socket The socket being read from.
+ *  @param data, size Where the bytes go and how many to read.
  */
-template <class DT>
-void LineSegment<DT>::displayEquation() {
-	cout << "y=" << round(this->slope()) << "*x+" << round(this->yIntercept().getYValue());
+void receiveAll(int socket, void* data, size_t size){
+#ifndef _WIN32
+	char* next = (char*)data;
+	while (size > 0){
+		ssize_t received = read(socket, next, size);
+		if (received <= 0)
+			throw SegmentsException();
+		next += received;
+		size -= received;
+	}
+#else
+	throw SegmentsException();
+#endif
 }
 
 /**
- *  Method that returns the first point of a line segment.
+ *  Function that finds which shard owns a tile.
  *
- *  @return P1 The first point of the line segment.
+ *  @param tileX, tileY The position of the tile on the tile grid.
+ *  @param shards The number of shards.
+ *  @return The number of the owning shard.
  */
-template <class DT>
-Point<DT> LineSegment<DT>::getP1() {
-	return P1;
+int shardOf(long long tileX, long long tileY, int shards){
+	unsigned long long hash = (unsigned long long)tileX * 73856093ULL ^ (unsigned long long)tileY * 19349663ULL;
+	return hash % shards;
 }
 
 /**
- *  Method that returns the second point of a line segment.
+ *  Function that finds the intersecting pairs a shard is responsible for. A
+ *  pair belongs to the shard owning the tile that holds the lower left
+ *  corner of the overlap of their bounding boxes, so every pair is found by
+ *  exactly one shard.
  *
- *  @return P2 The second point of the line segment.
+ *  @param records, removed The shard's segments and the removed indices.
+ *  @param shard The number of this shard.
+ *  @param shards The number of shards.
+ *  @param tileSize The width of a square tile.
+ *  @param pairs Where the pairs go, or NULL to only count them.
+ *  @return total The number of pairs found.
  */
 template <class DT>
-Point<DT> LineSegment<DT>::getP2() {
-	return P2;
+long long findShardPairs(vector<SegmentRecord>& records, vector<int>& removed, int shard, int shards, double tileSize, vector<ShardPair>* pairs){
+	vector<SegmentRecord> sorted;
+	for (int i = 0; i < (int)records.size(); i++){
+		if (!binary_search(removed.begin(), removed.end(), records[i].index))
+			sorted.push_back(records[i]);
+	}
+	sort(sorted.begin(), sorted.end(), recordBefore);
+	long long total = 0;
+	for (int a = 0; a < (int)sorted.size(); a++){
+		LineSegment<DT> first = LineSegment<DT>(Point<DT>(sorted[a].x1, sorted[a].y1), Point<DT>(sorted[a].x2, sorted[a].y2));
+		double rightA = (sorted[a].x1 > sorted[a].x2 ? sorted[a].x1 : sorted[a].x2);
+		double lowA = (sorted[a].y1 < sorted[a].y2 ? sorted[a].y1 : sorted[a].y2);
+		for (int b = a + 1; b < (int)sorted.size(); b++){
+			double leftB = (sorted[b].x1 < sorted[b].x2 ? sorted[b].x1 : sorted[b].x2);
+			if (leftB > rightA)
+				break;
+			double lowB = (sorted[b].y1 < sorted[b].y2 ? sorted[b].y1 : sorted[b].y2);
+			if (shardOf(cellOf(leftB, tileSize), cellOf(lowA > lowB ? lowA : lowB, tileSize), shards) != shard)
+				continue;
+			LineSegment<DT> second = LineSegment<DT>(Point<DT>(sorted[b].x1, sorted[b].y1), Point<DT>(sorted[b].x2, sorted[b].y2));
+			if (first.isParallel(second) == true || first.itIntersects(second) == false)
+				continue;
+			total++;
+			if (pairs == NULL)
+				continue;
+			//The point is worked out from the earlier segment, as the
+			//in-memory display does.
+			bool aFirst = sorted[a].index < sorted[b].index;
+			Point<DT> P = (aFirst ? first.intersectionPoint(second) : second.intersectionPoint(first));
+			ShardPair pair = {aFirst ? sorted[a].index : sorted[b].index, aFirst ? sorted[b].index : sorted[a].index,
+				(double)P.getXValue(), (double)P.getYValue()};
+			pairs->push_back(pair);
+		}
+	}
+	return total;
 }
 
+/**
+ *  Function that runs one shard process. The shard keeps its own copy of
+ *  every segment touching one of its tiles and answers requests from the
+ *  coordinator until it is told to quit or the socket closes.
+ *
+ *  @param socket The shard's end of the socket to the coordinator.
+ *  @param shard The number of this shard.
+ *  @param shards The number of shards.
+ *  @param tileSize The width of a square tile.
+ */
+template <class DT>
+void serveShard(int socket, int shard, int shards, double tileSize){
+	vector<SegmentRecord> records;
+	vector<int> removed;
+	while (true){
+		ShardRequest request;
+		try{
+			receiveAll(socket, &request, sizeof(request));
+		}
+		catch (SegmentsException &e) {
+			return;
+		}
+		LineSegment<DT> line = LineSegment<DT>(Point<DT>(request.x1, request.y1), Point<DT>(request.x2, request.y2));
+		switch (request.command) {
+			case 'A':
+			{
+				SegmentRecord record = {request.index, request.x1, request.y1, request.x2, request.y2};
+				records.push_back(record);
+				break;
+			}
+			case 'R':
+			{
+				int first = -1;
+				for (int i = 0; i < (int)records.size(); i++){
+					if (records[i].x1 == request.x1 && records[i].y1 == request.y1
+							&& records[i].x2 == request.x2 && records[i].y2 == request.y2
+							&& !binary_search(removed.begin(), removed.end(), records[i].index)
+							&& (first < 0 || records[i].index < first))
+						first = records[i].index;
+				}
+				sendAll(socket, &first, sizeof(first));
+				break;
+			}
+			case 'D':
+			{
+				removed.insert(lower_bound(removed.begin(), removed.end(), request.index), request.index);
+				break;
+			}
+			case 'I':
+			{
+				vector<int> found;
+				for (int i = 0; i < (int)records.size(); i++){
+					LineSegment<DT> segment = LineSegment<DT>(Point<DT>(records[i].x1, records[i].y1), Point<DT>(records[i].x2, records[i].y2));
+					if (segment.isParallel(line) == false && segment.itIntersects(line) == true
+							&& !binary_search(removed.begin(), removed.end(), records[i].index))
+						found.push_back(records[i].index);
+				}
+				int size = found.size();
+				sendAll(socket, &size, sizeof(size));
+				sendAll(socket, found.data(), size * sizeof(int));
+				break;
+			}
+			case 'C':
+			{
+				Point<DT> aPoint = Point<DT>(request.x1, request.y1);
+				vector<ShardNeighbour> nearest;
+				for (int i = 0; i < (int)records.size(); i++){
+					if (binary_search(removed.begin(), removed.end(), records[i].index))
+						continue;
+					LineSegment<DT> segment = LineSegment<DT>(Point<DT>(records[i].x1, records[i].y1), Point<DT>(records[i].x2, records[i].y2));
+					ShardNeighbour neighbour = {distance(aPoint, segment), records[i].index};
+					nearest.push_back(neighbour);
+				}
+				int size = (request.k < (int)nearest.size() ? request.k : nearest.size());
+				partial_sort(nearest.begin(), nearest.begin() + size, nearest.end());
+				sendAll(socket, &size, sizeof(size));
+				sendAll(socket, nearest.data(), size * sizeof(ShardNeighbour));
+				break;
+			}
+			case 'K':
+			{
+				long long total = findShardPairs<DT>(records, removed, shard, shards, tileSize, NULL);
+				sendAll(socket, &total, sizeof(total));
+				break;
+			}
+			case 'X':
+			{
+				vector<ShardPair> pairs;
+				findShardPairs<DT>(records, removed, shard, shards, tileSize, &pairs);
+				sort(pairs.begin(), pairs.end());
+				long long size = pairs.size();
+				sendAll(socket, &size, sizeof(size));
+				sendAll(socket, pairs.data(), size * sizeof(ShardPair));
+				break;
+			}
+			case 'Q':
+				return;
+		}
+	}
+}
 
 /**
- * 	Class that holds multiple line segments to be displayed.
+ *  Class that spreads line segments over several shard processes on the same
+ *  machine. The plane is split into square tiles, each tile is owned by one
+ *  shard, and a segment is copied to the owner of every tile its bounding
+ *  box touches. The coordinator forwards additions and removals to the
+ *  owning shards, fans queries out to them over local sockets and merges
+ *  what comes back.
  */
 template <class DT>
-class Segments {
+class ShardedSegments {
 	protected:
-		LineSegment<DT>* segments;
+		int shards;
+		double tileSize;
+		vector<int> sockets;
+		vector<int> processes;
+		vector<int> removed;
 		int count;
-		int maxSize;
+		vector<int> ownersOf(LineSegment<DT>& L);
+		void sendRequest(int shard, char command, int index, int k, LineSegment<DT>& L);
+		int position(int index);
+		void stopShards();
 	public:
-		Segments();
-		Segments(int size);
+		ShardedSegments(int shardCount, double size);
+		~ShardedSegments();
 		void addLineSegment(LineSegment<DT> L);
-		void display();
-		Segments<DT>& aClosedPolygon();
-		//Segments<DT>& findAllIntersects(LineSegment<DT>& LS);
-		~Segments();
-		LineSegment<DT>& findClosest(Point<DT>& aPoint);
-		int findClosestIndex(Point<DT>& aPoint);
+		bool removeLineSegment(Point<DT>& one, Point<DT>& two);
+		vector<int> findAllIntersects(LineSegment<DT>& LS);
+		vector<int> findClosest(Point<DT>& aPoint, int k);
+		long long countAllIntersections();
+		long long displayAllIntersections(ostream& s);
 		int getSize();
-		LineSegment<DT> getSegmentAt(int index);
-		friend ostream& operator << <DT>(ostream& s, Segments<DT>& seg);
 };
 
 /**
- *  Overloaded << operator for the Segments class.
+ *  Constructor for the ShardedSegments class, which starts the shard
+ *  processes. If one cannot be started, the ones already running are
+ *  stopped before the exception is thrown.
+ *
+ *  @param shardCount The number of shard processes.
+ *  @param size The width of a square tile.
  */
 template <class DT>
-ostream& operator << (ostream& s, Segments<DT>& seg){
-	for (int i = 0; i < seg.maxSize; i++){
-		Point<double> P1 = seg.getSegmentAt(i).getP1();
-		Point<double> P2 = seg.getSegmentAt(i).getP2();
-		Point<double> mid = seg.getSegmentAt(i).midpoint();
-		LineSegment<double> segment = seg.getSegmentAt(i);
-		s << "Line Segment " << (i+1) << ":" << endl
-		<< P1 << "," << P2 << endl
-		<< "Slope:" << round(seg.getSegmentAt(i).slope()) << endl;
-		try{
-			if (seg.getSegmentAt(i).length() == 0)
-				throw LineSegmentException();
-			s << "Midpoint:" << mid << endl;
+ShardedSegments<DT>::ShardedSegments(int shardCount, double size) {
+	if (shardCount < 1 || size <= 0)
+		throw SegmentsException();
+	shards = shardCount;
+	tileSize = size;
+	count = 0;
+#ifndef _WIN32
+	signal(SIGPIPE, SIG_IGN);
+	cout.flush();
+	for (int i = 0; i < shards; i++){
+		int pair[2];
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0){
+			stopShards();
+			throw SegmentsException();
+		}
+		pid_t process = fork();
+		if (process < 0){
+			close(pair[0]);
+			close(pair[1]);
+			stopShards();
+			throw SegmentsException();
 		}
-		catch (LineSegmentException &e) {
-			s << "Exception,length is 0" << endl;
+		if (process == 0){
+			close(pair[0]);
+			for (int j = 0; j < (int)sockets.size(); j++)
+				close(sockets[j]);
+			serveShard<DT>(pair[1], i, shards, tileSize);
+			_exit(0);
 		}
-		s << "X Intercept:" << round(seg.getSegmentAt(i).xIntercept().getXValue()) << endl
-		<< "Y Intercept:" << round(seg.getSegmentAt(i).yIntercept().getYValue()) << endl
-		<< "Length:" << round(seg.getSegmentAt(i).length()) << endl
-		<< segment << endl;
+		close(pair[1]);
+		sockets.push_back(pair[0]);
+		processes.push_back(process);
 	}
-	return s;
+#else
+	throw SegmentsException();
+#endif
 }
 
 /**
- *  Default constructor for the Intervals class.
+ *  Destructor for the ShardedSegments class, which stops the shard
+ *  processes.
  */
 template <class DT>
-Segments<DT>::Segments() {
-	segments = NULL;
-	count = 0;
-	maxSize = 0;
+ShardedSegments<DT>::~ShardedSegments() {
+	stopShards();
 }
 
 /**
- * 	Constructor for the Intervals class.
- *
- * 	@param size The length of the array of LineSegments.
+ *  Method that stops every shard process started so far, closes its socket
+ *  and waits for it to finish.
  */
 template <class DT>
-Segments<DT>::Segments(int size) {
-	segments = new LineSegment<DT> [size];
-	count = 0;
-	maxSize = size;
+void ShardedSegments<DT>::stopShards(){
+#ifndef _WIN32
+	LineSegment<DT> none;
+	for (int i = 0; i < (int)sockets.size(); i++){
+		try{
+			sendRequest(i, 'Q', 0, 0, none);
+		}
+		catch (SegmentsException &e) {}
+		close(sockets[i]);
+		waitpid(processes[i], NULL, 0);
+	}
+	sockets.clear();
+	processes.clear();
+#endif
 }
 
 /**
- * 	Method that adds a Line Segment to the array of segments.
+ *  Method that finds the shards owning the tiles a segment's bounding box
+ *  touches. Very large boxes simply go to every shard.
  *
- * 	@param L The line segment to be added.
+ *  @param L The line segment.
+ *  @return owners The numbers of the owning shards.
  */
 template <class DT>
-void Segments<DT>::addLineSegment(LineSegment<DT> L){
-	if (count < maxSize){
-		segments[count] = L;
-		count++;
+vector<int> ShardedSegments<DT>::ownersOf(LineSegment<DT>& L){
+	double x1 = L.getP1().getXValue(), x2 = L.getP2().getXValue();
+	double y1 = L.getP1().getYValue(), y2 = L.getP2().getYValue();
+	long long firstX = cellOf(x1 < x2 ? x1 : x2, tileSize), lastX = cellOf(x1 > x2 ? x1 : x2, tileSize);
+	long long firstY = cellOf(y1 < y2 ? y1 : y2, tileSize), lastY = cellOf(y1 > y2 ? y1 : y2, tileSize);
+	vector<bool> owns(shards, false);
+	if ((lastX - firstX + 1) * (lastY - firstY + 1) > MAX_TILES_PER_SEGMENT * shards){
+		owns.assign(shards, true);
+	} else {
+		for (long long tx = firstX; tx <= lastX; tx++){
+			for (long long ty = firstY; ty <= lastY; ty++)
+				owns[shardOf(tx, ty, shards)] = true;
+		}
+	}
+	vector<int> owners;
+	for (int i = 0; i < shards; i++){
+		if (owns[i])
+			owners.push_back(i);
 	}
+	return owners;
 }
 
 /**
- *  Method that finds the distance between a point and a LineSegment.
+ *  Method that sends one request to a shard.
  *
- *  @param P The point used for comparison.
- *  @param L The line segment being compared.
- *  @return distance The distance between the line and the point.
+ *  @param shard The number of the shard.
+ *  @param command The letter of the request.
+ *  @param index, k The index and count the request carries, if any.
+ *  @param L The line segment the request carries, if any.
  */
 template <class DT>
-double distance(Point<DT> P, LineSegment<DT> L){
-	double x0, y0, m, c;
-	double denominator, numerator;
-	double distance;
-
-	x0 = P.getXValue();
-	y0 = P.getYValue();
-	m = L.slope();
-	c = L.yIntercept().getYValue();
-	//cout << "[" << x0 << ", " << y0 << ", " << m << ", " << c << "]" << endl;
-
-	denominator = squareroot(1 + m * m);
-	numerator = m*x0 - y0 + c;
-	if (numerator < 0){
-		numerator -= (2 * numerator);
-	}
-	//cout << "{" << numerator << "/" << denominator << "}" << endl;
-	distance = numerator/denominator;
-	return distance;
+void ShardedSegments<DT>::sendRequest(int shard, char command, int index, int k, LineSegment<DT>& L){
+	ShardRequest request = {command, index, k, L.getP1().getXValue(), L.getP1().getYValue(), L.getP2().getXValue(), L.getP2().getYValue()};
+	sendAll(sockets[shard], &request, sizeof(request));
 }
 
 /**
- * 	Displays various features of the current line segment, as well as any intersections
- * 	that may occur between line segments.
+ *  Method that finds where a segment would sit in an in-memory Segments
+ *  array, after every segment removed before it has been shifted out.
+ *
+ *  @param index The index the segment was added with.
+ *  @return The position of the segment.
  */
 template <class DT>
-void Segments<DT>::display(){
-	for (int i = 0; i < maxSize; i++){
-		cout << "Line Segment " << (i+1) << ":" << endl;
-		segments[i].getP1().display();
-		cout << ",";
-		segments[i].getP2().display();
-		cout << endl << "Slope:" << round(segments[i].slope()) << endl
-		<< "Midpoint:";
-		try{
-			if (segments[i].length() == 0)
-				throw LineSegmentException();
-			segments[i].midpoint().display();
-		}
-		catch (LineSegmentException &e) {
-			cout << "Exception,length is 0" << endl;
-		}
-		cout << endl << "X Intercept:" << round(segments[i].xIntercept().getXValue());
-		cout << endl << "Y Intercept:" << round(segments[i].yIntercept().getYValue());
-		cout << endl << "Length:" << round(segments[i].length()) << endl;
-		segments[i].displayEquation();
-		cout << endl;
-	}
-
-	for (int i = 0; i < maxSize; i++){
-		for (int j = i+1; j < maxSize; j++){
-			cout << "The line segments compared are segments[" << i << "] and segments[" << j << "]: ";
-			if (segments[i].isParallel(segments[j]) == true){
-				cout << "Lines are Parallel"<< endl;
-			}
-			else if (segments[i].itIntersects(segments[j]) == false){
-				cout << "Not Parallel and not Intersecting" << endl;
-			}
-			else{
-				cout << "Intersection Point :";
-				segments[i].intersectionPoint(segments[j]).display();
-				cout << endl;
-			}
-		}
-	}
+int ShardedSegments<DT>::position(int index){
+	return index - (lower_bound(removed.begin(), removed.end(), index) - removed.begin());
 }
 
 /**
- *  Method that attempts to find a closed polygon based on the given line segments.
+ *  Method that sends a line segment to every shard owning a tile it touches.
  *
- *  (UNFINISHED)
+ *  @param L The line segment to be added.
  */
 template <class DT>
-Segments<DT>& Segments<DT>::aClosedPolygon(){
-	//TODO: implement this
-//	Segments<DT> polygon = Segments<DT>(this->maxSize);
-//	for (int i = 0; i < this->maxSize*2; i++){
-//		if (i % 2 == 0){ //i is even
-//			Point<DT> P = this->segments[i/2].getP1();
-//			int count = 0;
-//			for (int j = 0; j < this->maxSize*2; j++){
-//				if (j % 2 == 0){
-//					if (P == this->segments[i/2].getP1())
-//						count++;
-//				}
-//				else{
-//					if (P == this->segments[i/2].getP2())
-//						count++;
-//				}
-//			}
-//			if (count >= 2){
-//
-//			}
-//		}
-//		else{ //i % 2 == 1; i is odd
-//			Point<DT> P = this->segments[i/2].getP2();
-//			int count = 0;
-//			for (int j = 0; j < this->maxSize*2; j++){
-//				if (j % 2 == 0){
-//					if (P == this->segments[i/2].getP1())
-//						count++;
-//				}
-//				else{
-//					if (P == this->segments[i/2].getP2())
-//						count++;
-//				}
-//			}
-//			if (count >= 2){
-//
-//			}
-//		}
-//	}
-//
-//	return polygon;
+void ShardedSegments<DT>::addLineSegment(LineSegment<DT> L){
+	vector<int> owners = ownersOf(L);
+	for (int i = 0; i < (int)owners.size(); i++)
+		sendRequest(owners[i], 'A', count, 0, L);
+	count++;
 }
 
 /**
- *  Method that finds all lines that intersect with a given LineSegment.
- *  WARNING! This method causes segmentation faults! Uncomment at your own risk!
+ *  Method that removes the first line segment with the given end points. The
+ *  shard owning the tile of the first end point holds every such segment, so
+ *  it picks the segment, and then every shard drops its copy.
  *
- *  @param LS The line segment used to find the intersects.
- *  @return intersects All of the lines that intersect with LS.
+ *  @param one, two The end points of the segment to remove.
+ *  @return Whether a matching segment was found.
  */
-//template <class DT>
-//Segments<DT>& Segments<DT>::findAllIntersects(LineSegment<DT>& LS){
-//	Segments<double> intersects = Segments(maxSize);
-//	for (int i = 0; i < maxSize; i++){
-//			if (segments[i].isParallel(LS) == true){
-//				intersects.addLineSegment(LineSegment<double>());
-//			}
-//			else if (segments[i].itIntersects(LS) == false){
-//				intersects.addLineSegment(LineSegment<double>());
-//			}
-//			else{
-//				intersects.addLineSegment(segments[i]);
-//			}
-//		}
-//	return intersects;
-//}
+template <class DT>
+bool ShardedSegments<DT>::removeLineSegment(Point<DT>& one, Point<DT>& two){
+	LineSegment<DT> line = LineSegment<DT>(one, two);
+	int owner = shardOf(cellOf(one.getXValue(), tileSize), cellOf(one.getYValue(), tileSize), shards);
+	sendRequest(owner, 'R', 0, 0, line);
+	int index;
+	receiveAll(sockets[owner], &index, sizeof(index));
+	if (index < 0)
+		return false;
+	for (int i = 0; i < shards; i++)
+		sendRequest(i, 'D', index, 0, line);
+	removed.insert(lower_bound(removed.begin(), removed.end(), index), index);
+	return true;
+}
 
 /**
- *  Destructor method for the Segments class.
+ *  Method that finds all lines that intersect with a given LineSegment by
+ *  asking every shard owning a tile it touches, all at once.
+ *
+ *  @param LS The line segment used to find the intersects.
+ *  @return found The positions of the intersecting segments, in order.
  */
 template <class DT>
-Segments<DT>::~Segments() {
-	delete segments;
+vector<int> ShardedSegments<DT>::findAllIntersects(LineSegment<DT>& LS){
+	vector<int> owners = ownersOf(LS);
+	for (int i = 0; i < (int)owners.size(); i++)
+		sendRequest(owners[i], 'I', 0, 0, LS);
+	vector<int> found;
+	for (int i = 0; i < (int)owners.size(); i++){
+		int size;
+		receiveAll(sockets[owners[i]], &size, sizeof(size));
+		vector<int> part(size);
+		receiveAll(sockets[owners[i]], part.data(), size * sizeof(int));
+		found.insert(found.end(), part.begin(), part.end());
+	}
+	sort(found.begin(), found.end());
+	found.erase(unique(found.begin(), found.end()), found.end());
+	for (int i = 0; i < (int)found.size(); i++)
+		found[i] = position(found[i]);
+	return found;
 }
 
 /**
- *  Method that finds the closest line segment to a point.
+ *  Method that finds the k closest line segments to a point. Since
+ *  distance() measures to the whole line, every shard sends back its own k
+ *  closest segments and the lists are merged.
  *
- *  @param aPoint The point being used to find the closest line.
- *  @return closest The closest line to aPoint.
+ *  @param aPoint The point being used to find the closest lines.
+ *  @param k The number of segments wanted.
+ *  @return closest The positions of the k closest lines, nearest first.
  */
 template <class DT>
-LineSegment<DT>& Segments<DT>::findClosest(Point<DT>& aPoint){
-	LineSegment<DT> closest = segments[this->findClosestIndex(aPoint)];
+vector<int> ShardedSegments<DT>::findClosest(Point<DT>& aPoint, int k){
+	LineSegment<DT> line = LineSegment<DT>(aPoint, aPoint);
+	for (int i = 0; i < shards; i++)
+		sendRequest(i, 'C', 0, k, line);
+	vector<ShardNeighbour> merged;
+	for (int i = 0; i < shards; i++){
+		int size;
+		receiveAll(sockets[i], &size, sizeof(size));
+		vector<ShardNeighbour> part(size);
+		receiveAll(sockets[i], part.data(), size * sizeof(ShardNeighbour));
+		merged.insert(merged.end(), part.begin(), part.end());
+	}
+	//Copies of a segment held by several shards end up next to each other.
+	sort(merged.begin(), merged.end());
+	vector<int> closest;
+	for (int i = 0; i < (int)merged.size() && (int)closest.size() < k; i++){
+		if (i > 0 && merged[i].index == merged[i-1].index)
+			continue;
+		closest.push_back(position(merged[i].index));
+	}
 	return closest;
 }
 
 /**
- * 	Method that finds the index of the closest line segment to a point.
+ *  Method that counts the pairs of intersecting line segments. Every shard
+ *  counts the pairs whose reference tile it owns, so the sum counts each
+ *  pair once.
  *
- * 	@param aPoint The point being used to find the closest line.
- * 	@return line The index of the closest line to aPoint.
+ *  @return total The number of intersecting pairs.
  */
 template <class DT>
-int Segments<DT>::findClosestIndex(Point<DT>& aPoint){
-	double shortest = 1.79769e+308;
-	int line = 0;
-	for (int i = 0; i < maxSize; i++){
-		double distanceFrom = distance(aPoint, segments[i]);
-		if (distanceFrom < shortest){
-			shortest = distanceFrom;
-			line = i;
-		}
+long long ShardedSegments<DT>::countAllIntersections(){
+	LineSegment<DT> none;
+	for (int i = 0; i < shards; i++)
+		sendRequest(i, 'K', 0, 0, none);
+	long long total = 0;
+	for (int i = 0; i < shards; i++){
+		long long part;
+		receiveAll(sockets[i], &part, sizeof(part));
+		total += part;
 	}
-	return line;
+	return total;
 }
 
 /**
- * 	Method that returns the size of the array.
+ *  Method that displays every pair of intersecting line segments. Every shard
+ *  sends back the pairs whose reference tile it owns, already in order, and
+ *  the coordinator merges them one pair at a time straight off the sockets,
+ *  so it never holds more than one pair per shard.
  *
- * 	@return maxSize The maximum size of segments.
+ *  @param s The stream the pairs are written to.
+ *  @return total The number of intersecting pairs.
  */
 template <class DT>
-int Segments<DT>::getSize(){
-	return maxSize;
+long long ShardedSegments<DT>::displayAllIntersections(ostream& s){
+	LineSegment<DT> none;
+	for (int i = 0; i < shards; i++)
+		sendRequest(i, 'X', 0, 0, none);
+	vector<long long> left(shards);
+	priority_queue<pair<ShardPair, int>, vector<pair<ShardPair, int> >, greater<pair<ShardPair, int> > > heads;
+	for (int i = 0; i < shards; i++){
+		receiveAll(sockets[i], &left[i], sizeof(left[i]));
+		if (left[i] == 0)
+			continue;
+		ShardPair head;
+		receiveAll(sockets[i], &head, sizeof(head));
+		left[i]--;
+		heads.push(make_pair(head, i));
+	}
+	long long total = 0;
+	while (!heads.empty()){
+		ShardPair next = heads.top().first;
+		int shard = heads.top().second;
+		heads.pop();
+		Point<DT> P = Point<DT>(next.x, next.y);
+		s << "Line segment " << (position(next.first)+1) << " and Line segment " << (position(next.second)+1)
+		<< ": Intersection Point :" << P << endl;
+		total++;
+		if (left[shard] == 0)
+			continue;
+		ShardPair head;
+		receiveAll(sockets[shard], &head, sizeof(head));
+		left[shard]--;
+		heads.push(make_pair(head, shard));
+	}
+	return total;
 }
 
 /**
- * 	Method that returns a specific line segment at a given index.
+ *  Method that returns the number of segments that have not been removed.
  *
- * 	@param index The chosen index of the line segment requested.
- * 	@return segment The line segment at the specified index.
+ *  @return The number of segments held.
  */
 template <class DT>
-LineSegment<DT> Segments<DT>::getSegmentAt(int index){
-	LineSegment<DT> segment = (segments[index]);
-	return segment;
+int ShardedSegments<DT>::getSize(){
+	return count - removed.size();
 }
 
 /**
@@ -728,9 +1422,18 @@ int main() {
 	char command;
 	int noOfSegments;
 	cin >> noOfSegments;
-	Segments<double> segments = Segments<double>(noOfSegments);
+	Segments<double> segments;
+	bool allocated = false;
+	bool batching = false;
+	TiledSegments<double>* tiled = NULL;
+	ShardedSegments<double>* sharded = NULL;
 
 	while (cin >> command && !cin.eof()) {
+		//The array is left unallocated until a command works in memory.
+		if (!allocated && tiled == NULL && sharded == NULL && command != 'O' && command != 'M' && command != 'B'){
+			segments = Segments<double>(noOfSegments);
+			allocated = true;
+		}
 		switch (command) {
 			case 'A': //Add a line segment
 			{
@@ -739,8 +1442,18 @@ int main() {
 				Point<double> one = Point<double>(P1x, P1y);
 				Point<double> two = Point<double>(P2x, P2y);
 				LineSegment<double> line = LineSegment<double>(one, two);
-				segments.addLineSegment(line);
-				cout << "Line segment added" << endl << endl;
+				try{
+					if (tiled != NULL)
+						tiled->addLineSegment(line);
+					else if (sharded != NULL)
+						sharded->addLineSegment(line);
+					else
+						segments.addLineSegment(line);
+					cout << "Line segment added" << endl << endl;
+				}
+				catch (SegmentsException &e) {
+					cout << "Exception,line segment outside the snap grid" << endl << endl;
+				}
 				break;
 			}
 			case 'R': //Remove a line segment
@@ -749,9 +1462,30 @@ int main() {
 				cin >> P1x >> P1y >> P2x >> P2y;
 				Point<double> one = Point<double>(P1x, P1y);
 				Point<double> two = Point<double>(P2x, P2y);
+				if (tiled != NULL || sharded != NULL){
+					try{
+						bool found;
+						if (tiled != NULL)
+							found = tiled->removeLineSegment(one, two);
+						else
+							found = sharded->removeLineSegment(one, two);
+						if (found == false)
+							throw SegmentsException();
+						cout << "Line segment removed" << endl << endl;
+					}
+					catch (SegmentsException &e) {
+						cout << "Exception,line segment not found" << endl << endl;
+					}
+					break;
+				}
 				int count = 0;
 				Segments<double> temp = Segments<double>(noOfSegments-1);
 				try{
+					if (segments.getGrid() > 0){
+						LineSegment<double> snapped = segments.snapSegment(LineSegment<double>(one, two));
+						one = snapped.getP1();
+						two = snapped.getP2();
+					}
 					for (int i = 0; i < noOfSegments; i++){
 						if (segments.getSegmentAt(i).getP1() == one && segments.getSegmentAt(i).getP2() == two)
 							break;
@@ -765,7 +1499,10 @@ int main() {
 							temp.addLineSegment(segments.getSegmentAt(i+1));
 						}
 						noOfSegments--;
+						double grid = segments.getGrid();
 						segments = Segments<double>(noOfSegments);
+						if (grid > 0)
+							segments.snapRound(grid);
 						for (int i = 0; i < noOfSegments; i++)
 							segments.addLineSegment(temp.getSegmentAt(i));
 					}
@@ -781,6 +1518,10 @@ int main() {
 			}
 			case 'D': //Display all line segments
 			{
+				if (tiled != NULL || sharded != NULL){
+					cout << "Exception,command not available out of core" << endl << endl;
+					break;
+				}
 				cout << segments << endl;
 				break;
 			}
@@ -798,48 +1539,259 @@ int main() {
 				break;
 			}
 			case 'I': //Display all intersects with a given line segment
+			{
+				//In batch mode a run of I commands is answered together in one
+				//sweep. This waits for the next command, so it is opt-in.
+				vector< LineSegment<double> > lines;
+				do {
+					double P1x, P1y, P2x, P2y;
+					cin >> P1x >> P1y >> P2x >> P2y;
+					Point<double> one = Point<double>(P1x, P1y);
+					Point<double> two = Point<double>(P2x, P2y);
+					lines.push_back(LineSegment<double>(one, two));
+				} while (batching && cin >> ws && cin.peek() == 'I' && cin.get());
+				vector< vector<int> > found;
+				try{
+					if (tiled != NULL){
+						for (int q = 0; q < (int)lines.size(); q++)
+							found.push_back(tiled->findAllIntersects(lines[q]));
+					}
+					else if (sharded != NULL){
+						for (int q = 0; q < (int)lines.size(); q++)
+							found.push_back(sharded->findAllIntersects(lines[q]));
+					}
+					else
+						found = segments.findAllIntersects(lines.data(), lines.size());
+				}
+				catch (SegmentsException &e) {
+					for (int q = 0; q < (int)lines.size(); q++)
+						cout << "Exception,line segment outside the snap grid" << endl << endl;
+				}
+				for (int q = 0; q < (int)found.size(); q++){
+					if (found[q].size() > 0){
+						cout << "The lines segments intersecting with the given line segment are:" << endl;
+						for (int i = 0; i < (int)found[q].size(); i++)
+							cout << "Line segment " << (found[q][i]+1) << endl;
+					}
+					else cout << "NO INTERSECTING LINE SEGMENTS" << endl;
+					cout << endl;
+				}
+				break;
+			}
+			case 'C': //Display line segment closest to a point
+			{
+				double PCx, PCy;
+				cin >> PCx >> PCy;
+				Point<double> chosen = Point<double>(PCx, PCy);
+				int index;
+				if (tiled != NULL)
+					index = tiled->findClosestIndex(chosen);
+				else if (sharded != NULL){
+					vector<int> closest = sharded->findClosest(chosen, 1);
+					index = (closest.empty() ? -1 : closest[0]);
+				}
+				else
+					index = segments.findClosestIndex(chosen);
+				cout << "The Line segment closest to the given point is:";
+				if (index < 0)
+					cout << "NO LINE SEGMENTS";
+				else
+					cout << "Line segment " << (index+1);
+				break;
+			}
+			case 'J': //Display all pairs of line segments within a given distance
+			{
+				double d;
+				cin >> d;
+				if (tiled != NULL || sharded != NULL){
+					cout << "Exception,command not available out of core" << endl << endl;
+					break;
+				}
+				try{
+					cout << "The line segments within the given distance are:" << endl;
+					if (segments.proximityJoin(d, cout) == 0)
+						cout << "NO LINE SEGMENTS WITHIN THE GIVEN DISTANCE" << endl;
+				}
+				catch (SegmentsException &e) {
+					cout << "Exception,distance must be positive" << endl;
+				}
+				catch (bad_alloc &e) {
+					cout << "Exception,not enough memory for the given distance" << endl;
+				}
+				cout << endl;
+				break;
+			}
+			case 'Q': //Display the two closest line segments that do not touch
+			{
+				if (tiled != NULL || sharded != NULL){
+					cout << "Exception,command not available out of core" << endl << endl;
+					break;
+				}
+				try{
+					int first, second;
+					double separation = segments.closestPair(first, second);
+					cout << "The closest line segments are:Line segment " << (first+1)
+					<< " and Line segment " << (second+1) << endl
+					<< "Distance:" << roundTwoDigits(separation) << endl;
+				}
+				catch (SegmentsException &e) {
+					cout << "Exception,no separate line segments" << endl;
+				}
+				cout << endl;
+				break;
+			}
+			case 'N': //Count the intersects with a given line segment
 			{
 				double P1x, P1y, P2x, P2y;
 				cin >> P1x >> P1y >> P2x >> P2y;
 				Point<double> one = Point<double>(P1x, P1y);
 				Point<double> two = Point<double>(P2x, P2y);
 				LineSegment<double> line = LineSegment<double>(one, two);
-				int lines = 0;
-				for (int i = 0; i < segments.getSize(); i++){
-					if (segments.getSegmentAt(i).isParallel(line) == true){}
-					else if (segments.getSegmentAt(i).itIntersects(line) == false){}
-					else{
-						lines++;
-					}
+				try{
+					int lines;
+					if (tiled != NULL)
+						lines = tiled->findAllIntersects(line).size();
+					else if (sharded != NULL)
+						lines = sharded->findAllIntersects(line).size();
+					else
+						lines = segments.countIntersects(line);
+					cout << "Number of line segments intersecting with the given line segment:" << lines << endl << endl;
+				}
+				catch (SegmentsException &e) {
+					cout << "Exception,line segment outside the snap grid" << endl << endl;
+				}
+				break;
+			}
+			case 'K': //Count every pair of intersecting line segments
+			{
+				long long pairs;
+				if (tiled != NULL)
+					pairs = tiled->countAllIntersections();
+				else if (sharded != NULL)
+					pairs = sharded->countAllIntersections();
+				else
+					pairs = segments.countAllIntersections();
+				cout << "Number of intersecting line segment pairs:" << pairs << endl << endl;
+				break;
+			}
+			case 'G': //Snap every line segment to a grid
+			{
+				double size;
+				cin >> size;
+				try{
+					if (tiled != NULL || sharded != NULL)
+						throw SegmentsException();
+					segments.snapRound(size);
+					cout << "Snap rounding enabled" << endl << endl;
+				}
+				catch (SegmentsException &e) {
+					cout << "Exception,snap rounding not enabled" << endl << endl;
+				}
+				break;
+			}
+			case 'O': //Move the line segments to disk and continue out of core
+			{
+				double tileSize;
+				int memoryBudget;
+				cin >> tileSize >> memoryBudget;
+				//The store only replaces the array once every segment is in it.
+				TiledSegments<double>* store = NULL;
+				try{
+					//The tiles on disk do not keep the snap grid, so snapped
+					//segments stay in memory.
+					if (tiled != NULL || sharded != NULL || segments.getGrid() > 0)
+						throw SegmentsException();
+					store = new TiledSegments<double>(tileSize, memoryBudget, "project2_tile");
+					for (int i = 0; i < segments.getCount(); i++)
+						store->addLineSegment(segments.getSegmentAt(i));
+					tiled = store;
+					segments = Segments<double>();
+					cout << "Out of core mode enabled" << endl << endl;
+				}
+				catch (SegmentsException &e) {
+					delete store;
+					cout << "Exception,out of core mode not enabled" << endl << endl;
+				}
+				break;
+			}
+			case 'M': //Spread the line segments over several shard processes
+			{
+				int shardCount;
+				double tileSize;
+				cin >> shardCount >> tileSize;
+				//The shards only replace the array once every segment is in them.
+				ShardedSegments<double>* store = NULL;
+				try{
+					//The shards do not keep the snap grid, so snapped segments
+					//stay in memory.
+					if (tiled != NULL || sharded != NULL || segments.getGrid() > 0)
+						throw SegmentsException();
+					store = new ShardedSegments<double>(shardCount, tileSize);
+					for (int i = 0; i < segments.getCount(); i++)
+						store->addLineSegment(segments.getSegmentAt(i));
+					sharded = store;
+					segments = Segments<double>();
+					cout << "Sharded mode enabled" << endl << endl;
+				}
+				catch (SegmentsException &e) {
+					delete store;
+					cout << "Exception,sharded mode not enabled" << endl << endl;
 				}
-				if (lines > 0){
-					cout << "The lines segments intersecting with the given line segment are:" << endl;
-					for (int i = 0; i < segments.getSize(); i++){
-						if (segments.getSegmentAt(i).isParallel(line) == true){}
-						else if (segments.getSegmentAt(i).itIntersects(line) == false){}
-						else{
-							cout << "Line segment " << (i+1) << endl;
+				break;
+			}
+			case 'X': //Display every pair of intersecting line segments
+			{
+				cout << "The intersecting line segments are:" << endl;
+				long long pairs = 0;
+				if (tiled != NULL)
+					pairs = tiled->displayAllIntersections(cout);
+				else if (sharded != NULL)
+					pairs = sharded->displayAllIntersections(cout);
+				else{
+					for (int i = 0; i < segments.getCount(); i++){
+						for (int j = i+1; j < segments.getCount(); j++){
+							LineSegment<double> second = segments.getSegmentAt(j);
+							if (segments.intersectsAt(i, second) == false)
+								continue;
+							Point<double> P = segments.intersectionPointAt(i, second);
+							cout << "Line segment " << (i+1) << " and Line segment " << (j+1)
+							<< ": Intersection Point :" << P << endl;
+							pairs++;
 						}
 					}
 				}
-				else cout << "NO INTERSECTING LINE SEGMENTS" << endl;
+				if (pairs == 0)
+					cout << "NO INTERSECTING LINE SEGMENTS" << endl;
 				cout << endl;
 				break;
 			}
-			case 'C': //Display line segment closest to a point
+			case 'S': //Display out of core disk and cache statistics
 			{
-				double PCx, PCy;
-				cin >> PCx >> PCy;
-				Point<double> chosen = Point<double>(PCx, PCy);
-				cout << "The Line segment closest to the given point is:";
-				cout << "Line segment " << (segments.findClosestIndex(chosen)+1);
+				if (tiled == NULL){
+					cout << "Exception,out of core mode not enabled" << endl << endl;
+					break;
+				}
+				tiled->displayStatistics(cout);
+				cout << endl;
+				break;
+			}
+			case 'B': //Turn batching of consecutive I commands on or off
+			{
+				int on;
+				cin >> on;
+				batching = (on != 0);
+				if (batching)
+					cout << "Batch mode enabled" << endl << endl;
+				else
+					cout << "Batch mode disabled" << endl << endl;
 				break;
 			}
 			default: cout << "Invalid command" << endl;
 		}
 	}
 
-	delete &segments;
+	delete tiled;
+	delete sharded;
 	return 0;
 }
 
@@ -0,0 +1,181 @@
+/*
+ * segments.cpp: The functions behind the Point, LineSegment and Segments
+ *  templates in segments.h that do not depend on the data type, so they are
+ *  compiled once into the library instead of into every program using it.
+ */
+
+#include "segments.h"
+
+namespace geometry {
+
+/**
+ *  Finds the square root of a given number.
+ *
+ * 	@param num The number of which we want to find the square root of.
+ * 	@return l The square root of num.
+ */
+double squareroot(double num) {
+	double eps = 1e-6;
+	double k = num;
+	double l = 0.0, r, mid;
+
+	if (k >= 1) {
+		r = k;
+	}
+	if (k < 1) {
+		r = 1;
+	}
+
+	while (l - k / l > eps || l - k / l < -eps) {
+		mid = l + (r - l) / 2;
+		if (mid < k / mid) {
+			l = mid;
+		} else {
+			r = mid;
+		}
+	}
+	return l;
+}
+
+/**
+ * 	Function that rounds the input number to two digits.
+ *
+ * 	@param var The number we want to round.
+ * 	@return value The input, rounded to two digits.
+ */
+double roundTwoDigits(double num) {
+    double rndnum;
+    double num2 = num * 100;
+    int num3 = (int)num2;
+    double dec3 = num2 - num3;
+    if ((dec3*10) >= 5) {
+        rndnum = ((int)((num)*100))/100.00 + 0.01;
+    } else {
+        rndnum= ((int)((num)*100))/100.00;
+    }
+    return rndnum;
+}
+
+/**
+ *  Comparison used to sort CellSpan objects from their lowest cell up.
+ */
+bool operator < (const CellSpan& a, const CellSpan& b){
+	if (a.low != b.low)
+		return a.low < b.low;
+	return a.index < b.index;
+}
+
+/**
+ *  Function that finds the cell a coordinate falls into on a grid.
+ *
+ *  @param value The coordinate.
+ *  @param cellSize The width of a grid cell.
+ *  @return The index of the cell along that axis.
+ */
+long long cellOf(double value, double cellSize){
+	double cell = value / cellSize;
+	long long index = (long long)cell;
+	if (index > cell)
+		index--;
+	return index;
+}
+
+/**
+ *  Function that counts the pairs i < j with values[i] >= values[j] using
+ *  merge sort. The values are left sorted.
+ *
+ *  @param values The values to count the inversions of.
+ *  @param buffer Scratch space at least as long as values.
+ *  @param first, last The range of values being counted, [first, last).
+ *  @return inversions The number of inverted pairs in the range.
+ */
+long long countInversions(double* values, double* buffer, int first, int last){
+	if (last - first < 2)
+		return 0;
+	int middle = first + (last - first) / 2;
+	long long inversions = countInversions(values, buffer, first, middle)
+			+ countInversions(values, buffer, middle, last);
+	int left = first, right = middle, next = first;
+	while (left < middle && right < last){
+		if (values[left] < values[right]){
+			buffer[next++] = values[left++];
+		} else {
+			//Every value still waiting on the left is at least values[right].
+			inversions += middle - left;
+			buffer[next++] = values[right++];
+		}
+	}
+	while (left < middle)
+		buffer[next++] = values[left++];
+	while (right < last)
+		buffer[next++] = values[right++];
+	for (int i = first; i < last; i++)
+		values[i] = buffer[i];
+	return inversions;
+}
+
+/**
+ *  Function that snaps a coordinate to the nearest point of a grid.
+ *
+ *  @param value The coordinate.
+ *  @param grid The distance between two grid points.
+ *  @return The grid coordinate closest to value.
+ */
+long long snapToGrid(double value, double grid){
+	double scaled = value / grid;
+	if (scaled > MAX_GRID_COORDINATE || scaled < -MAX_GRID_COORDINATE)
+		throw SegmentsException();
+	return cellOf(scaled + 0.5, 1.0);
+}
+
+/**
+ *  Function that finds which side of the line through grid points a and b
+ *  the grid point c is on. The test is exact.
+ *
+ *  @return 1 if the point is to the left, -1 if it is to the right and 0 if
+ *  	it lies on the line.
+ */
+int gridOrientation(long long ax, long long ay, long long bx, long long by, long long cx, long long cy){
+	long long cross = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+	if (cross > 0)
+		return 1;
+	if (cross < 0)
+		return -1;
+	return 0;
+}
+
+/**
+ *  Function that determines whether two snapped line segments intersect.
+ *  Like itIntersects(), parallel segments never count as intersecting, even
+ *  when they overlap.
+ *
+ *  @param A, B The segments' end points as grid coordinates {x1, y1, x2, y2}.
+ *  @return Whether the two segments intersect.
+ */
+bool gridIntersects(long long* A, long long* B){
+	int o1 = gridOrientation(A[0], A[1], A[2], A[3], B[0], B[1]);
+	int o2 = gridOrientation(A[0], A[1], A[2], A[3], B[2], B[3]);
+	if (o1 == o2)
+		return false;
+	int o3 = gridOrientation(B[0], B[1], B[2], B[3], A[0], A[1]);
+	int o4 = gridOrientation(B[0], B[1], B[2], B[3], A[2], A[3]);
+	return o3 != o4;
+}
+
+/**
+ *  Function that finds which side of the line through (ax, ay) and (bx, by)
+ *  the point (cx, cy) is on.
+ *
+ *  @return 1 if the point is to the left, -1 if it is to the right and 0 if
+ *  	it lies on the line.
+ */
+int orientation(double ax, double ay, double bx, double by, double cx, double cy){
+	double cross = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+	if (cross > 0)
+		return 1;
+	if (cross < 0)
+		return -1;
+	return 0;
+}
+
+} /* namespace geometry */
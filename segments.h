@@ -0,0 +1,1813 @@
+/*
+ * segments.h: The Point, LineSegment and Segments classes, along with the
+ *  geometry functions they share, all in the geometry namespace. Programs
+ *  include this header and link with segments.cpp to use the classes
+ *  directly, without going through the text commands read by project2.cpp.
+ */
+
+#ifndef SEGMENTS_H_
+#define SEGMENTS_H_
+
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <condition_variable>
+#include <set>
+#include <map>
+#include <queue>
+
+namespace geometry {
+
+/**
+ *  Function prototype for squareroot.
+ */
+double squareroot(double num);
+
+/**
+ *  Function prototype for roundTwoDigits.
+ */
+double roundTwoDigits(double num);
+
+
+
+/**
+ * 	Class that is responsible for handling any exception thrown to it.
+ */
+class Exception{};
+
+
+/**
+ * 	Class that handles exceptions specifically caused by LineSegment.
+ */
+class LineSegmentException: public Exception{};
+
+
+/**
+ * 	Class that handles exceptions specifically caused by Segments.
+ */
+class SegmentsException: public Exception{};
+
+/**
+ *  Class prototype for Point.
+ */
+template <class DT> class Point;
+
+/**
+ * 	Method prototype for the overloaded << operator for the Point class.
+ */
+template <class DT> std::ostream& operator << (std::ostream& s, Point<DT>& aPoint);
+
+
+/**
+ *  Class prototype for LineSegment.
+ */
+template <class DT> class LineSegment;
+
+/**
+ * 	Method prototype for the overloaded << operator for the LineSegment class.
+ */
+template <class DT> std::ostream& operator << (std::ostream& s, LineSegment<DT>& LS);
+
+/**
+ *  Class prototype for Segments.
+ */
+template <class DT> class Segments;
+
+/**
+ * 	Method prototype for the overloaded << operator for the Segments class.
+ */
+template <class DT> std::ostream& operator << (std::ostream& s, Segments<DT>& seg);
+
+
+/**
+ * 	Class that holds two doubles as a point along an x/y plane.
+ */
+template <class DT>
+class Point {
+	friend std::ostream& operator << <DT>(std::ostream& s, Point<DT>& aPoint);
+protected:
+	double x;
+	double y;
+public:
+	Point();
+	Point(double xVal, double yVal);
+	void setLocation(double xVal, double yVal);
+	double getXValue();
+	double getYValue();
+	void display();
+	bool operator == (Point<DT>& P);
+
+};
+
+/**
+ * 	Overloaded << operator for the Point class.
+ */
+template <class DT>
+std::ostream& operator<<(std::ostream& s, Point<DT>& aPoint){
+	s << "(" << roundTwoDigits(aPoint.x) << ", " << roundTwoDigits(aPoint.y) << ")";
+	return s;
+}
+
+/**
+ *  Overloaded == operator for the Point class.
+ */
+template <class DT>
+bool Point<DT>::operator == (Point<DT>& P){
+	return ((x == P.x) && (y == P.y));
+}
+
+/**
+ *  Default constructor for the Point class.
+ */
+template <class DT>
+Point<DT>::Point() {
+	x = 0.0;
+	y = 0.0;
+}
+
+/**
+ *  Constructor for the Point class.
+ *
+ *  @param xVal, yVal The coordinates of the new Point object.
+ */
+template <class DT>
+Point<DT>::Point(double xVal, double yVal) {
+	x = xVal;
+	y = yVal;
+}
+
+/**
+ *  Modifier for a Point's x & y variables.
+ *
+ * 	@param xVal, yVal The new coordinates of a Point Object.
+ */
+template <class DT>
+void Point<DT>::setLocation(double xVal, double yVal) {
+	x = xVal;
+	y = yVal;
+}
+
+/**
+ * 	Method that returns the X value of a Point.
+ *
+ * 	@return x The x coordinate of a Point.
+ */
+template <class DT>
+double Point<DT>::getXValue() {
+	return x;
+}
+
+/**
+ * 	Method that returns the Y value of a Point.
+ *
+ * 	@return y The Y coordinate of a Point.
+ */
+template <class DT>
+double Point<DT>::getYValue() {
+	return y;
+}
+
+/**
+ * 	Method that displays the Point in it's normal form
+ * 	e.g. (0, 4), (-12.4, 32.39), (x, y)
+ */
+template <class DT>
+void Point<DT>::display() {
+	std::cout << "(" << roundTwoDigits(x) << ", " << roundTwoDigits(y) << ")";
+}
+
+
+/**
+ * 	Class that holds a line segment consisting of two points along an x/y plane.
+ */
+template <class DT>
+class LineSegment {
+protected:
+	Point<DT> P1;
+	Point<DT> P2;
+public:
+	LineSegment();
+	LineSegment(Point<DT> one, Point<DT> two);
+	double length();
+	Point<DT> midpoint();
+	Point<DT> xIntercept();
+	Point<DT> yIntercept();
+	double slope();
+	bool itIntersects(LineSegment L);
+	Point<DT> intersectionPoint(LineSegment L);
+	bool isParallel(LineSegment L);
+	void displayEquation();
+	Point<DT> getP1();
+	Point<DT> getP2();
+	friend std::ostream& operator << <DT>(std::ostream& s, LineSegment<DT>& LS);
+};
+
+/**
+ * 	Overloaded << operator for the LineSegment class.
+ */
+template <class DT>
+std::ostream& operator << (std::ostream& s, LineSegment<DT>& LS){
+	s << "y=" << roundTwoDigits(LS.slope()) << "*x+" << roundTwoDigits(LS.yIntercept().getYValue());
+	return s;
+}
+
+/**
+ * 	Default constructor for the LineSegment class.
+ */
+template <class DT>
+LineSegment<DT>::LineSegment() {
+	P1 = Point<DT>(0, 0);
+	P2 = Point<DT>(0, 0);
+}
+
+/**
+ * 	Constructor for the LineSegment class.
+ *
+ * 	@param one, two Points that make up the line segment.
+ */
+template <class DT>
+LineSegment<DT>::LineSegment(Point<DT> one, Point<DT> two) {
+	P1 = one;
+	P2 = two;
+}
+
+/**
+ * 	Method that finds the length of a line segment.
+ *
+ * 	@return length The length of the object.
+ */
+template <class DT>
+double LineSegment<DT>::length() {
+	double length = 0.0;
+	length = squareroot(((P2.getXValue() - P1.getXValue()) * (P2.getXValue() - P1.getXValue())) + ((P2.getYValue() - P1.getYValue()) * (P2.getYValue() - P1.getYValue())));
+	return length;
+}
+
+/**
+ *  Method that finds the midpoint of a line segment.
+ *
+ *  @return mid The point at the middle of the line segment.
+ */
+template <class DT>
+Point<DT> LineSegment<DT>::midpoint() {
+	Point<DT> mid;
+	mid = Point<DT>(roundTwoDigits((P1.getXValue() + P2.getXValue()) / 2), roundTwoDigits((P1.getYValue() + P2.getYValue()) / 2));
+	return mid;
+}
+
+/**
+ * 	Method that finds the x-intercept of a line segment. The method assumes that the point
+ * 	is a part of a whole line in order to find the intercept, rather than just the segment itself.
+ *
+ * 	@return xInt The x-intercept of the line.
+ */
+template <class DT>
+Point<DT> LineSegment<DT>::xIntercept() {
+	Point<DT> xInt;
+	double slope = this->slope();
+	double x = 0.0;
+	x = -((this->yIntercept().getYValue())/slope);
+	xInt = Point<DT>(x, 0);
+	return xInt;
+}
+
+/**
+ * 	Method that finds the y-intercept of a line segment. The method assumes that the point
+ * 	is a part of a whole line in order to find the intercept, rather than just the segment itself.
+ *
+ * 	@return yInt The y-intercept of the line.
+ */
+template <class DT>
+Point<DT> LineSegment<DT>::yIntercept() {
+	Point<DT> yInt;
+	double slope = this->slope();
+	double y = 0.0;
+	y = P1.getYValue() - (slope)*P1.getXValue();
+	yInt = Point<DT>(0, y);
+	return yInt;
+}
+
+/**
+ * 	Method that finds the slope of a line segment.
+ *
+ * 	@return slope The slope of the line.
+ */
+template <class DT>
+double LineSegment<DT>::slope() {
+	double slope = 0.0;
+	slope = ((P2.getYValue() - P1.getYValue()) / (P2.getXValue() - P1.getXValue()));
+	return slope;
+}
+
+/**
+ * 	Method that determines whether two line segments intersect or not.
+ *
+ * 	@param L The line segment that is currently being compared to.
+ * 	@return intersect The status of whether the lines are intersected or not.
+ */
+template <class DT>
+bool LineSegment<DT>::itIntersects(LineSegment L) {
+	bool intersect = false;
+	if (this->slope() != L.slope()){
+		Point<DT> potentialIntersect = intersectionPoint(L);
+		double first = this->P1.getXValue();
+		double second = this->P2.getXValue();
+		double third = L.P1.getXValue();
+		double fourth = L.P2.getXValue();
+		double potential = potentialIntersect.getXValue();
+		if (first > second){
+			first = this->P2.getXValue();
+			second = this->P1.getXValue();
+		}
+		if (third > fourth){
+			third = L.P2.getXValue();
+			fourth = L.P1.getXValue();
+		}
+		if (first <= potential && potential <= second && third <= potential && potential <= fourth){
+			intersect = true;
+		}
+	}
+	return intersect;
+}
+
+/**
+ * 	Method that finds the intersection of two line segments.
+ *
+ * 	@param L the line segment that is being used (along with the current line).
+ * 	@return intersection The point at which the two segments intersect.
+ */
+template <class DT>
+Point<DT> LineSegment<DT>::intersectionPoint(LineSegment L) {
+	Point<DT> intersection;
+	double x = roundTwoDigits((L.yIntercept().getYValue() - this->yIntercept().getYValue())/(this->slope() - L.slope()));
+	double y = roundTwoDigits(((this->yIntercept().getYValue()*L.slope())-(L.yIntercept().getYValue()*this->slope()))/(L.slope() - this->slope()));
+	intersection = Point<DT>(x, y);
+	return intersection;
+}
+
+/**
+ * 	Determines whether two line segments are parallel based on their slopes.
+ *
+ * 	@param L The line segment that is currently being compared to.
+ * 	@return parallel The status of whether the lines are parallel or not.
+ */
+template <class DT>
+bool LineSegment<DT>::isParallel(LineSegment L) {
+	bool parallel = false;
+	if (this->slope() == L.slope())
+		parallel = true;
+	return parallel;
+}
+
+/**
+ *  Displays the line's formula as an equation in y=mx+c form.
+ *  e.g. y=1.4x+5, y=-6x+-2
+ */
+template <class DT>
+void LineSegment<DT>::displayEquation() {
+	std::cout << "y=" << roundTwoDigits(this->slope()) << "*x+" << roundTwoDigits(this->yIntercept().getYValue());
+}
+
+/**
+ *  Method that returns the first point of a line segment.
+ *
+ *  @return P1 The first point of the line segment.
+ */
+template <class DT>
+Point<DT> LineSegment<DT>::getP1() {
+	return P1;
+}
+
+/**
+ *  Method that returns the second point of a line segment.
+ *
+ *  @return P2 The second point of the line segment.
+ */
+template <class DT>
+Point<DT> LineSegment<DT>::getP2() {
+	return P2;
+}
+
+
+/**
+ *  Struct that holds the run of cells, from low to high, that a line segment
+ *  covers in one column of the spatial hash used by proximityJoin().
+ */
+struct CellSpan {
+	long long low;
+	long long high;
+	int index;
+};
+
+/**
+ *  Function prototype for the < operator for CellSpan.
+ */
+bool operator < (const CellSpan& a, const CellSpan& b);
+
+/**
+ *  Struct that holds one pair of line segments found by proximityJoin(),
+ *  along with the row of the cell it was reported from.
+ */
+struct SegmentPair {
+	long long cell;
+	int first;
+	int second;
+	double distance;
+};
+
+/**
+ *  Function prototype for cellOf.
+ */
+long long cellOf(double value, double cellSize);
+
+/**
+ *  Function prototype for countInversions.
+ */
+long long countInversions(double* values, double* buffer, int first, int last);
+
+/**
+ *  Largest grid coordinate a snapped point may have, so the orientation tests
+ *  on grid coordinates always fit in a long long.
+ */
+const long long MAX_GRID_COORDINATE = 1LL << 29;
+
+/**
+ *  Function prototype for snapToGrid.
+ */
+long long snapToGrid(double value, double grid);
+
+/**
+ *  Function prototype for gridOrientation.
+ */
+int gridOrientation(long long ax, long long ay, long long bx, long long by, long long cx, long long cy);
+
+/**
+ *  Function prototype for gridIntersects.
+ */
+bool gridIntersects(long long* A, long long* B);
+
+/**
+ * 	Class that holds multiple line segments to be displayed.
+ */
+template <class DT>
+class Segments {
+	protected:
+		LineSegment<DT>* segments;
+		int count;
+		int maxSize;
+		double grid;
+		long long* gridPoints;
+		void reserve(int size);
+	public:
+		Segments();
+		Segments(int size);
+		Segments(const Segments<DT>& other);
+		Segments<DT>& operator = (const Segments<DT>& other);
+		Segments<DT>& operator = (Segments<DT>&& other);
+		void addLineSegment(LineSegment<DT> L);
+		int addLineSegments(const double* coordinates, int n);
+		void display();
+		Segments<DT>& aClosedPolygon();
+		//Segments<DT>& findAllIntersects(LineSegment<DT>& LS);
+		~Segments();
+		LineSegment<DT>& findClosest(Point<DT>& aPoint);
+		int findClosestIndex(Point<DT>& aPoint);
+		int proximityJoin(double d, std::ostream& s);
+		double closestPair(int& first, int& second);
+		int countIntersects(LineSegment<DT>& LS);
+		std::vector< std::vector<int> > findAllIntersects(LineSegment<DT>* queries, int q);
+		long long findAllIntersects(const double* queries, int q, int* offsets, int* indices, long long capacity);
+		void findClosestIndices(const double* points, int n, int* indices);
+		long long countAllIntersections();
+		void snapRound(double size);
+		LineSegment<DT> snapSegment(LineSegment<DT> L);
+		bool intersectsAt(int index, LineSegment<DT>& L);
+		Point<DT> intersectionPointAt(int index, LineSegment<DT>& L);
+		double getGrid();
+		int getSize();
+		int getCount();
+		LineSegment<DT> getSegmentAt(int index);
+		friend std::ostream& operator << <DT>(std::ostream& s, Segments<DT>& seg);
+};
+
+/**
+ *  Overloaded << operator for the Segments class.
+ */
+template <class DT>
+std::ostream& operator << (std::ostream& s, Segments<DT>& seg){
+	for (int i = 0; i < seg.maxSize; i++){
+		Point<double> P1 = seg.getSegmentAt(i).getP1();
+		Point<double> P2 = seg.getSegmentAt(i).getP2();
+		Point<double> mid = seg.getSegmentAt(i).midpoint();
+		LineSegment<double> segment = seg.getSegmentAt(i);
+		s << "Line Segment " << (i+1) << ":" << std::endl
+		<< P1 << "," << P2 << std::endl
+		<< "Slope:" << roundTwoDigits(seg.getSegmentAt(i).slope()) << std::endl;
+		try{
+			if (seg.getSegmentAt(i).length() == 0)
+				throw LineSegmentException();
+			s << "Midpoint:" << mid << std::endl;
+		}
+		catch (LineSegmentException &e) {
+			s << "Exception,length is 0" << std::endl;
+		}
+		s << "X Intercept:" << roundTwoDigits(seg.getSegmentAt(i).xIntercept().getXValue()) << std::endl
+		<< "Y Intercept:" << roundTwoDigits(seg.getSegmentAt(i).yIntercept().getYValue()) << std::endl
+		<< "Length:" << roundTwoDigits(seg.getSegmentAt(i).length()) << std::endl
+		<< segment << std::endl;
+	}
+	return s;
+}
+
+/**
+ *  Default constructor for the Intervals class.
+ */
+template <class DT>
+Segments<DT>::Segments() {
+	segments = NULL;
+	count = 0;
+	maxSize = 0;
+	grid = 0.0;
+	gridPoints = NULL;
+}
+
+/**
+ * 	Constructor for the Intervals class.
+ *
+ * 	@param size The length of the array of LineSegments.
+ */
+template <class DT>
+Segments<DT>::Segments(int size) {
+	segments = new LineSegment<DT> [size];
+	count = 0;
+	maxSize = size;
+	grid = 0.0;
+	gridPoints = NULL;
+}
+
+/**
+ * 	Copy constructor for the Segments class.
+ *
+ * 	@param other The Segments object being copied.
+ */
+template <class DT>
+Segments<DT>::Segments(const Segments<DT>& other) {
+	segments = NULL;
+	gridPoints = NULL;
+	count = 0;
+	maxSize = 0;
+	grid = 0.0;
+	*this = other;
+}
+
+/**
+ * 	Overloaded = operator for the Segments class, which copies the arrays
+ * 	instead of sharing them, so the copy outlives the original.
+ */
+template <class DT>
+Segments<DT>& Segments<DT>::operator = (const Segments<DT>& other){
+	if (this == &other)
+		return *this;
+	LineSegment<DT>* copied = new LineSegment<DT> [other.maxSize];
+	for (int i = 0; i < other.count; i++)
+		copied[i] = other.segments[i];
+	long long* copiedPoints = NULL;
+	if (other.gridPoints != NULL){
+		copiedPoints = new long long[4 * other.maxSize];
+		for (int i = 0; i < 4 * other.count; i++)
+			copiedPoints[i] = other.gridPoints[i];
+	}
+	delete[] segments;
+	delete[] gridPoints;
+	segments = copied;
+	gridPoints = copiedPoints;
+	count = other.count;
+	maxSize = other.maxSize;
+	grid = other.grid;
+	return *this;
+}
+
+/**
+ * 	Move = operator for the Segments class, which takes over the arrays of a
+ * 	temporary instead of copying them, so no second array is allocated.
+ */
+template <class DT>
+Segments<DT>& Segments<DT>::operator = (Segments<DT>&& other){
+	if (this == &other)
+		return *this;
+	delete[] segments;
+	delete[] gridPoints;
+	segments = other.segments;
+	gridPoints = other.gridPoints;
+	count = other.count;
+	maxSize = other.maxSize;
+	grid = other.grid;
+	other.segments = NULL;
+	other.gridPoints = NULL;
+	other.count = 0;
+	other.maxSize = 0;
+	return *this;
+}
+
+/**
+ * 	Method that adds a Line Segment to the array of segments. If snap
+ * 	rounding is on, the segment is snapped to the grid first.
+ *
+ * 	@param L The line segment to be added.
+ */
+template <class DT>
+void Segments<DT>::addLineSegment(LineSegment<DT> L){
+	if (count < maxSize){
+		if (grid > 0){
+			long long* P = gridPoints + 4 * count;
+			P[0] = snapToGrid(L.getP1().getXValue(), grid);
+			P[1] = snapToGrid(L.getP1().getYValue(), grid);
+			P[2] = snapToGrid(L.getP2().getXValue(), grid);
+			P[3] = snapToGrid(L.getP2().getYValue(), grid);
+			L = LineSegment<DT>(Point<DT>(P[0] * grid, P[1] * grid), Point<DT>(P[2] * grid, P[3] * grid));
+		}
+		segments[count] = L;
+		count++;
+	}
+}
+
+/**
+ *  Method that finds the distance between a point and a LineSegment.
+ *
+ *  @param P The point used for comparison.
+ *  @param L The line segment being compared.
+ *  @return distance The distance between the line and the point.
+ */
+template <class DT>
+double distance(Point<DT> P, LineSegment<DT> L){
+	double x0, y0, m, c;
+	double denominator, numerator;
+	double distance;
+
+	x0 = P.getXValue();
+	y0 = P.getYValue();
+	m = L.slope();
+	c = L.yIntercept().getYValue();
+	//cout << "[" << x0 << ", " << y0 << ", " << m << ", " << c << "]" << endl;
+
+	denominator = squareroot(1 + m * m);
+	numerator = m*x0 - y0 + c;
+	if (numerator < 0){
+		numerator -= (2 * numerator);
+	}
+	//cout << "{" << numerator << "/" << denominator << "}" << endl;
+	distance = numerator/denominator;
+	return distance;
+}
+
+/**
+ *  Function that finds the closest spot on a line segment to a point.
+ *
+ *  @param x0, y0 The coordinates of the point.
+ *  @param L The line segment being compared.
+ *  @param px, py Receive the coordinates of the closest spot on L.
+ *  @return The squared distance between the point and the segment.
+ */
+template <class DT>
+double closestSpotOnSegment(double x0, double y0, LineSegment<DT>& L, double& px, double& py){
+	double ax = L.getP1().getXValue();
+	double ay = L.getP1().getYValue();
+	double dx = L.getP2().getXValue() - ax;
+	double dy = L.getP2().getYValue() - ay;
+	double lengthSquared = dx * dx + dy * dy;
+	double t = 0.0;
+	if (lengthSquared > 0){
+		t = ((x0 - ax) * dx + (y0 - ay) * dy) / lengthSquared;
+		if (t < 0)
+			t = 0;
+		if (t > 1)
+			t = 1;
+	}
+	px = ax + t * dx;
+	py = ay + t * dy;
+	return (px - x0) * (px - x0) + (py - y0) * (py - y0);
+}
+
+/**
+ *  Function that finds the squared distance between a point and the closest
+ *  spot on a line segment (rather than the whole line, like distance() does).
+ *
+ *  @param x0, y0 The coordinates of the point.
+ *  @param L The line segment being compared.
+ *  @return The squared distance between the point and the segment.
+ */
+template <class DT>
+double pointSegmentDistanceSquared(double x0, double y0, LineSegment<DT>& L){
+	double px, py;
+	return closestSpotOnSegment(x0, y0, L, px, py);
+}
+
+/**
+ *  Function prototype for orientation.
+ */
+int orientation(double ax, double ay, double bx, double by, double cx, double cy);
+
+/**
+ *  Function that determines whether two line segments touch anywhere, using
+ *  orientation tests instead of slopes so vertical and collinear segments
+ *  are handled as well.
+ *
+ *  @param A, B The line segments being compared.
+ *  @return Whether the two segments share at least one point.
+ */
+template <class DT>
+bool segmentsTouch(LineSegment<DT>& A, LineSegment<DT>& B){
+	double ax = A.getP1().getXValue(), ay = A.getP1().getYValue();
+	double bx = A.getP2().getXValue(), by = A.getP2().getYValue();
+	double cx = B.getP1().getXValue(), cy = B.getP1().getYValue();
+	double dx = B.getP2().getXValue(), dy = B.getP2().getYValue();
+	int o1 = orientation(ax, ay, bx, by, cx, cy);
+	int o2 = orientation(ax, ay, bx, by, dx, dy);
+	int o3 = orientation(cx, cy, dx, dy, ax, ay);
+	int o4 = orientation(cx, cy, dx, dy, bx, by);
+	if (o1 != o2 && o3 != o4)
+		return true;
+	//Collinear cases: an endpoint lying on the other segment.
+	if (o1 == 0 && pointSegmentDistanceSquared(cx, cy, A) == 0)
+		return true;
+	if (o2 == 0 && pointSegmentDistanceSquared(dx, dy, A) == 0)
+		return true;
+	if (o3 == 0 && pointSegmentDistanceSquared(ax, ay, B) == 0)
+		return true;
+	if (o4 == 0 && pointSegmentDistanceSquared(bx, by, B) == 0)
+		return true;
+	return false;
+}
+
+/**
+ *  Function that finds the squared distance between two line segments. If
+ *  the segments do not touch, the closest spots always include an endpoint of
+ *  one of them, so only four point to segment distances are needed.
+ *
+ *  @param A, B The line segments being compared.
+ *  @return The squared distance between the two segments.
+ */
+template <class DT>
+double segmentDistanceSquared(LineSegment<DT>& A, LineSegment<DT>& B){
+	if (segmentsTouch(A, B))
+		return 0.0;
+	double shortest = pointSegmentDistanceSquared(A.getP1().getXValue(), A.getP1().getYValue(), B);
+	double other = pointSegmentDistanceSquared(A.getP2().getXValue(), A.getP2().getYValue(), B);
+	if (other < shortest)
+		shortest = other;
+	other = pointSegmentDistanceSquared(B.getP1().getXValue(), B.getP1().getYValue(), A);
+	if (other < shortest)
+		shortest = other;
+	other = pointSegmentDistanceSquared(B.getP2().getXValue(), B.getP2().getYValue(), A);
+	if (other < shortest)
+		shortest = other;
+	return shortest;
+}
+
+/**
+ *  Function that finds the squared distance between two line segments along
+ *  with the point halfway between their closest spots, which is no further
+ *  than half that distance from either segment. When the segments cross,
+ *  the point is where they cross.
+ *
+ *  @param A, B The line segments being compared.
+ *  @param x, y Receive the coordinates of the halfway point.
+ *  @return The squared distance between the two segments.
+ */
+template <class DT>
+double segmentMeetingPoint(LineSegment<DT>& A, LineSegment<DT>& B, double& x, double& y){
+	double ax = A.getP1().getXValue(), ay = A.getP1().getYValue();
+	double bx = A.getP2().getXValue(), by = A.getP2().getYValue();
+	double cx = B.getP1().getXValue(), cy = B.getP1().getYValue();
+	double dx = B.getP2().getXValue(), dy = B.getP2().getYValue();
+	bool touch = segmentsTouch(A, B);
+	if (touch){
+		double denominator = (bx - ax) * (dy - cy) - (by - ay) * (dx - cx);
+		if (denominator != 0){
+			double t = ((cx - ax) * (dy - cy) - (cy - ay) * (dx - cx)) / denominator;
+			if (t < 0)
+				t = 0;
+			if (t > 1)
+				t = 1;
+			x = ax + t * (bx - ax);
+			y = ay + t * (by - ay);
+			return 0.0;
+		}
+	}
+	//Otherwise the closest spots include an endpoint of one of the segments,
+	//and for touching parallel segments that endpoint lies on the other one.
+	double ends[4][2] = {{ax, ay}, {bx, by}, {cx, cy}, {dx, dy}};
+	double shortest = -1;
+	for (int e = 0; e < 4; e++){
+		double px, py;
+		double squared = closestSpotOnSegment(ends[e][0], ends[e][1], (e < 2 ? B : A), px, py);
+		if (shortest < 0 || squared < shortest){
+			shortest = squared;
+			x = (ends[e][0] + px) / 2;
+			y = (ends[e][1] + py) / 2;
+		}
+	}
+	return (touch ? 0.0 : shortest);
+}
+
+/**
+ *  Function that finds the exact distance between two line segments.
+ *
+ *  @param A, B The line segments being compared.
+ *  @return The shortest distance between any two points of A and B.
+ */
+template <class DT>
+double segmentDistance(LineSegment<DT> A, LineSegment<DT> B){
+	double squared = segmentDistanceSquared(A, B);
+	if (squared == 0)
+		return 0.0;
+	return squareroot(squared);
+}
+
+/**
+ * 	Displays various features of the current line segment, as well as any intersections
+ * 	that may occur between line segments.
+ */
+template <class DT>
+void Segments<DT>::display(){
+	for (int i = 0; i < maxSize; i++){
+		std::cout << "Line Segment " << (i+1) << ":" << std::endl;
+		segments[i].getP1().display();
+		std::cout << ",";
+		segments[i].getP2().display();
+		std::cout << std::endl << "Slope:" << roundTwoDigits(segments[i].slope()) << std::endl
+		<< "Midpoint:";
+		try{
+			if (segments[i].length() == 0)
+				throw LineSegmentException();
+			segments[i].midpoint().display();
+		}
+		catch (LineSegmentException &e) {
+			std::cout << "Exception,length is 0" << std::endl;
+		}
+		std::cout << std::endl << "X Intercept:" << roundTwoDigits(segments[i].xIntercept().getXValue());
+		std::cout << std::endl << "Y Intercept:" << roundTwoDigits(segments[i].yIntercept().getYValue());
+		std::cout << std::endl << "Length:" << roundTwoDigits(segments[i].length()) << std::endl;
+		segments[i].displayEquation();
+		std::cout << std::endl;
+	}
+
+	for (int i = 0; i < maxSize; i++){
+		for (int j = i+1; j < maxSize; j++){
+			std::cout << "The line segments compared are segments[" << i << "] and segments[" << j << "]: ";
+			if (segments[i].isParallel(segments[j]) == true){
+				std::cout << "Lines are Parallel"<< std::endl;
+			}
+			else if (segments[i].itIntersects(segments[j]) == false){
+				std::cout << "Not Parallel and not Intersecting" << std::endl;
+			}
+			else{
+				std::cout << "Intersection Point :";
+				segments[i].intersectionPoint(segments[j]).display();
+				std::cout << std::endl;
+			}
+		}
+	}
+}
+
+/**
+ *  Method that attempts to find a closed polygon based on the given line segments.
+ *
+ *  (UNFINISHED)
+ */
+template <class DT>
+Segments<DT>& Segments<DT>::aClosedPolygon(){
+	//TODO: implement this
+//	Segments<DT> polygon = Segments<DT>(this->maxSize);
+//	for (int i = 0; i < this->maxSize*2; i++){
+//		if (i % 2 == 0){ //i is even
+//			Point<DT> P = this->segments[i/2].getP1();
+//			int count = 0;
+//			for (int j = 0; j < this->maxSize*2; j++){
+//				if (j % 2 == 0){
+//					if (P == this->segments[i/2].getP1())
+//						count++;
+//				}
+//				else{
+//					if (P == this->segments[i/2].getP2())
+//						count++;
+//				}
+//			}
+//			if (count >= 2){
+//
+//			}
+//		}
+//		else{ //i % 2 == 1; i is odd
+//			Point<DT> P = this->segments[i/2].getP2();
+//			int count = 0;
+//			for (int j = 0; j < this->maxSize*2; j++){
+//				if (j % 2 == 0){
+//					if (P == this->segments[i/2].getP1())
+//						count++;
+//				}
+//				else{
+//					if (P == this->segments[i/2].getP2())
+//						count++;
+//				}
+//			}
+//			if (count >= 2){
+//
+//			}
+//		}
+//	}
+//
+//	return polygon;
+}
+
+/**
+ *  Method that finds all lines that intersect with a given LineSegment.
+ *  WARNING! This method causes segmentation faults! Uncomment at your own risk!
+ *
+ *  @param LS The line segment used to find the intersects.
+ *  @return intersects All of the lines that intersect with LS.
+ */
+//template <class DT>
+//Segments<DT>& Segments<DT>::findAllIntersects(LineSegment<DT>& LS){
+//	Segments<double> intersects = Segments(maxSize);
+//	for (int i = 0; i < maxSize; i++){
+//			if (segments[i].isParallel(LS) == true){
+//				intersects.addLineSegment(LineSegment<double>());
+//			}
+//			else if (segments[i].itIntersects(LS) == false){
+//				intersects.addLineSegment(LineSegment<double>());
+//			}
+//			else{
+//				intersects.addLineSegment(segments[i]);
+//			}
+//		}
+//	return intersects;
+//}
+
+/**
+ *  Destructor method for the Segments class.
+ */
+template <class DT>
+Segments<DT>::~Segments() {
+	delete[] segments;
+	delete[] gridPoints;
+}
+
+/**
+ *  Method that finds the closest line segment to a point.
+ *
+ *  @param aPoint The point being used to find the closest line.
+ *  @return closest The closest line to aPoint.
+ */
+template <class DT>
+LineSegment<DT>& Segments<DT>::findClosest(Point<DT>& aPoint){
+	int index = this->findClosestIndex(aPoint);
+	if (index < 0)
+		throw SegmentsException();
+	LineSegment<DT> closest = segments[index];
+	return closest;
+}
+
+/**
+ * 	Method that finds the index of the closest line segment to a point.
+ *
+ * 	@param aPoint The point being used to find the closest line.
+ * 	@return line The index of the closest line to aPoint, or -1 when there
+ * 	are no line segments.
+ */
+template <class DT>
+int Segments<DT>::findClosestIndex(Point<DT>& aPoint){
+	double shortest = 1.79769e+308;
+	int line = (count > 0 ? 0 : -1);
+	for (int i = 0; i < count; i++){
+		double distanceFrom = distance(aPoint, segments[i]);
+		if (distanceFrom < shortest){
+			shortest = distanceFrom;
+			line = i;
+		}
+	}
+	return line;
+}
+
+/**
+ *  Method that finds every pair of line segments that are no further than d
+ *  apart. The plane is split into a grid of width d, and each segment covers
+ *  the cells its path passes within d/2 of. Two segments within d of each
+ *  other both pass within d/2 of the point halfway between their closest
+ *  spots, and the pair is only reported from the cell holding that point, so
+ *  each pair comes out once.
+ *
+ *  The grid is worked through one column at a time, keeping only the
+ *  segments that reach the current column and the run of cells each one
+ *  covers there, so memory stays O(n) however long the segments are.
+ *  Columns reached by fewer than two segments are skipped. The columns are
+ *  split into blocks shared between several threads. Blocks are written out
+ *  in column order, and cells from the bottom up within a column, so the
+ *  output does not depend on how the threads are scheduled. A thread whose
+ *  block is next writes each column as soon as it is done; the others hold
+ *  a limited number of pairs and then wait their turn.
+ *
+ *  @param d The largest distance allowed between two segments.
+ *  @param s The stream each qualifying pair is written to.
+ *  @return found The number of pairs within distance d.
+ */
+template <class DT>
+int Segments<DT>::proximityJoin(double d, std::ostream& s){
+	if (d <= 0)
+		throw SegmentsException();
+
+	double limit = d * d;
+	std::vector<double> x0(count), y0(count), x1(count), y1(count), reach(count);
+	std::vector<long long> firstX(count), lastX(count);
+	std::vector< std::pair<long long, int> > changes;
+	for (int i = 0; i < count; i++){
+		x0[i] = segments[i].getP1().getXValue();
+		y0[i] = segments[i].getP1().getYValue();
+		x1[i] = segments[i].getP2().getXValue();
+		y1[i] = segments[i].getP2().getYValue();
+		if (x1[i] < x0[i]){
+			std::swap(x0[i], x1[i]);
+			std::swap(y0[i], y1[i]);
+		}
+		//Leave room for rounding in the halfway point computed later.
+		double largest = std::max(std::max(std::fabs(x0[i]), std::fabs(x1[i])), std::max(std::fabs(y0[i]), std::fabs(y1[i])));
+		reach[i] = d / 2 * (1 + 1e-9) + largest * 1e-12;
+		firstX[i] = cellOf(x0[i] - reach[i], d);
+		lastX[i] = cellOf(x1[i] + reach[i], d);
+		changes.push_back(std::make_pair(firstX[i], 1));
+		changes.push_back(std::make_pair(lastX[i] + 1, -1));
+	}
+	std::sort(changes.begin(), changes.end());
+
+	//Only columns reached by at least two segments can hold a pair. Each
+	//busy range [first, second) starts at ordinal busyStart among them.
+	std::vector< std::pair<long long, long long> > busy;
+	std::vector<long long> busyStart;
+	long long columns = 0;
+	int reaching = 0;
+	for (int e = 0; e < (int)changes.size();){
+		long long at = changes[e].first;
+		while (e < (int)changes.size() && changes[e].first == at)
+			reaching += changes[e++].second;
+		if (reaching >= 2){
+			busy.push_back(std::make_pair(at, changes[e].first));
+			busyStart.push_back(columns);
+			columns += changes[e].first - at;
+		}
+	}
+	if (columns == 0)
+		return 0;
+	std::vector<int> byFirst(count);
+	for (int i = 0; i < count; i++)
+		byFirst[i] = i;
+	std::sort(byFirst.begin(), byFirst.end(), [&](int i, int j){
+		return firstX[i] < firstX[j];
+	});
+
+	int threads = std::thread::hardware_concurrency();
+	if (threads < 1)
+		threads = 1;
+	long long blocks = std::min(columns, (long long)threads * 8);
+	long long blockSize = (columns + blocks - 1) / blocks;
+	blocks = (columns + blockSize - 1) / blockSize;
+	if (threads > blocks)
+		threads = blocks;
+
+	int total = 0;
+	std::mutex output;
+	std::condition_variable turn;
+	long long written = 0;
+	const int HELD_PAIRS = 4096;
+	std::atomic<long long> nextBlock(0);
+	std::atomic<bool> failed(false);
+	std::exception_ptr failure;
+	std::vector<std::thread> workers;
+	for (int t = 0; t < threads; t++){
+		workers.push_back(std::thread([&](){
+			try{
+				std::vector<int> active;
+				std::vector<CellSpan> spans;
+				std::vector<SegmentPair> found, held;
+				//Writes the held pairs if every earlier block is written, waiting
+				//for that if asked to. The last write hands the turn on.
+				auto write = [&](long long block, bool wait, bool last){
+					std::unique_lock<std::mutex> lock(output);
+					if (wait)
+						turn.wait(lock, [&](){ return written == block || failed; });
+					if (failed || written != block)
+						return;
+					for (int p = 0; p < (int)held.size(); p++){
+						s << "Line segment " << (held[p].first+1) << " and Line segment " << (held[p].second+1)
+						<< ": " << roundTwoDigits(held[p].distance) << std::endl;
+					}
+					total += held.size();
+					held.clear();
+					if (last){
+						written++;
+						turn.notify_all();
+					}
+				};
+				for (long long block = nextBlock++; block < blocks && !failed; block = nextBlock++){
+					long long from = block * blockSize, to = std::min(columns, from + blockSize);
+					int range = std::upper_bound(busyStart.begin(), busyStart.end(), from) - busyStart.begin() - 1;
+					long long column = busy[range].first + (from - busyStart[range]);
+					active.clear();
+					for (int i = 0; i < count; i++){
+						if (firstX[i] <= column && column <= lastX[i])
+							active.push_back(i);
+					}
+					int next = std::upper_bound(byFirst.begin(), byFirst.end(), column, [&](long long c, int i){
+						return c < firstX[i];
+					}) - byFirst.begin();
+					for (long long ordinal = from; ordinal < to; ordinal++){
+						if (ordinal == busyStart[range] + (busy[range].second - busy[range].first))
+							column = busy[++range].first;
+						while (next < count && firstX[byFirst[next]] <= column){
+							if (lastX[byFirst[next]] >= column)
+								active.push_back(byFirst[next]);
+							next++;
+						}
+						//The cells each segment covers in this column.
+						spans.clear();
+						for (int a = 0; a < (int)active.size(); a++){
+							int i = active[a];
+							if (lastX[i] < column){
+								active[a--] = active.back();
+								active.pop_back();
+								continue;
+							}
+							double low = std::max(x0[i], column * d - reach[i]);
+							double high = std::min(x1[i], (column + 1) * d + reach[i]);
+							if (low > high)
+								low = high = (low > x1[i] ? x1[i] : x0[i]);
+							double yLow = y0[i], yHigh = y1[i];
+							if (x1[i] > x0[i]){
+								yLow = y0[i] + (low - x0[i]) * (y1[i] - y0[i]) / (x1[i] - x0[i]);
+								yHigh = y0[i] + (high - x0[i]) * (y1[i] - y0[i]) / (x1[i] - x0[i]);
+							}
+							if (yHigh < yLow)
+								std::swap(yLow, yHigh);
+							CellSpan span = {cellOf(yLow - reach[i], d), cellOf(yHigh + reach[i], d), i};
+							spans.push_back(span);
+						}
+						std::sort(spans.begin(), spans.end());
+						found.clear();
+						for (int a = 0; a < (int)spans.size(); a++){
+							for (int b = a + 1; b < (int)spans.size() && spans[b].low <= spans[a].high; b++){
+								int i = std::min(spans[a].index, spans[b].index), j = std::max(spans[a].index, spans[b].index);
+								double x, y;
+								double squared = segmentMeetingPoint(segments[i], segments[j], x, y);
+								if (squared > limit || cellOf(x, d) != column)
+									continue;
+								long long cell = cellOf(y, d);
+								if (cell < spans[b].low || cell > std::min(spans[a].high, spans[b].high))
+									continue;
+								SegmentPair pair = {cell, i, j, (squared == 0 ? 0.0 : squareroot(squared))};
+								found.push_back(pair);
+							}
+						}
+						std::sort(found.begin(), found.end(), [](const SegmentPair& a, const SegmentPair& b){
+							if (a.cell != b.cell)
+								return a.cell < b.cell;
+							if (a.first != b.first)
+								return a.first < b.first;
+							return a.second < b.second;
+						});
+						held.insert(held.end(), found.begin(), found.end());
+						if (!held.empty())
+							write(block, (int)held.size() > HELD_PAIRS, false);
+						column++;
+					}
+					write(block, true, true);
+				}
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(output);
+				if (!failed)
+					failure = std::current_exception();
+				failed = true;
+				turn.notify_all();
+			}
+		}));
+	}
+	for (int t = 0; t < threads; t++)
+		workers[t].join();
+	if (failed)
+		std::rethrow_exception(failure);
+	return total;
+}
+
+/**
+ *  Method that finds all lines that intersect with each of several given
+ *  LineSegments at once. The stored segments and the queries are swept from
+ *  left to right together. Each side keeps its active segments grouped by
+ *  height and ordered by their lowest y value, so a new segment is only
+ *  tested against segments of the other side whose bounding boxes overlap
+ *  its own.
+ *
+ *  Without a grid, intersectsAt() only checks that the rounded x value of the
+ *  crossing lies in both x ranges, so each y range is widened by how far the
+ *  lines can move over that rounding first. Vertical segments, and every
+ *  segment once coordinates get large enough for the rounding to overflow,
+ *  are tested on x alone. Stored segments and queries can cross among
+ *  themselves, so a red-blue sweep bound of O((n+q+k) log n) does not apply;
+ *  the work follows the number of overlapping boxes instead.
+ *
+ *  @param queries The line segments used to find the intersects.
+ *  @param q The number of queries.
+ *  @return found For each query, in order, the indices of the segments that
+ *  	intersect with it, from smallest to largest.
+ */
+template <class DT>
+std::vector< std::vector<int> > Segments<DT>::findAllIntersects(LineSegment<DT>* queries, int q){
+	std::vector< LineSegment<DT> > snappedQueries;
+	if (grid > 0){
+		for (int k = 0; k < q; k++)
+			snappedQueries.push_back(snapSegment(queries[k]));
+		queries = snappedQueries.data();
+	}
+	//A single query gains nothing from sorting, so it is a plain scan.
+	if (q == 1){
+		std::vector< std::vector<int> > found(1);
+		for (int i = 0; i < count; i++){
+			if (intersectsAt(i, queries[0]))
+				found[0].push_back(i);
+		}
+		return found;
+	}
+	int total = count + q;
+	double* left = new double[total];
+	double* right = new double[total];
+	double* low = new double[total];
+	double* high = new double[total];
+	int* group = new int[total];
+	int* order = new int[total];
+	double largest = 0;
+	for (int k = 0; k < total; k++){
+		LineSegment<DT>& segment = (k < count ? segments[k] : queries[k - count]);
+		double values[4] = {segment.getP1().getXValue(), segment.getP1().getYValue(),
+				segment.getP2().getXValue(), segment.getP2().getYValue()};
+		for (int v = 0; v < 4; v++)
+			largest = std::max(largest, std::fabs(values[v]));
+	}
+	//How far the rounded crossing can be from the crossing of the lines.
+	double shift = 0.0101 + 1e-15 * (largest + 1);
+	const int UNBOUNDED = 1 << 20, FLAT = -2000;
+	for (int k = 0; k < total; k++){
+		LineSegment<DT>& segment = (k < count ? segments[k] : queries[k - count]);
+		double x1 = segment.getP1().getXValue(), x2 = segment.getP2().getXValue();
+		double y1 = segment.getP1().getYValue(), y2 = segment.getP2().getYValue();
+		left[k] = (x1 < x2 ? x1 : x2);
+		right[k] = (x1 > x2 ? x1 : x2);
+		low[k] = (y1 < y2 ? y1 : y2);
+		high[k] = (y1 > y2 ? y1 : y2);
+		order[k] = k;
+		if (grid <= 0){
+			double slope = (y2 - y1) / (x2 - x1);
+			if (x1 == x2 || !std::isfinite(slope) || largest > 1e7){
+				group[k] = UNBOUNDED;
+				continue;
+			}
+			double m = std::fabs(slope);
+			double pad = m * shift + 1e-12 * (std::fabs(y1) + std::fabs(y2) + m * (std::fabs(x1) + std::fabs(x2)) + 1);
+			low[k] -= pad;
+			high[k] += pad;
+		}
+		group[k] = (high[k] > low[k] ? std::ilogb(high[k] - low[k]) : FLAT);
+	}
+	std::sort(order, order + total, [&](int i, int j){
+		return left[i] < left[j];
+	});
+
+	typedef std::map< int, std::set< std::pair<double, int> > > Groups;
+	typedef std::priority_queue< std::pair<double, int>, std::vector< std::pair<double, int> >, std::greater< std::pair<double, int> > > Ends;
+	std::vector< std::vector<int> > found(q);
+	Groups active[2];
+	Ends ends[2];
+	for (int k = 0; k < total; k++){
+		int i = order[k];
+		int side = (i < count ? 0 : 1), other = 1 - side;
+		while (!ends[other].empty() && ends[other].top().first < left[i]){
+			int j = ends[other].top().second;
+			active[other][group[j]].erase(std::make_pair(low[j], j));
+			if (active[other][group[j]].empty())
+				active[other].erase(group[j]);
+			ends[other].pop();
+		}
+		for (typename Groups::iterator g = active[other].begin(); g != active[other].end(); ++g){
+			bool unbounded = (group[i] == UNBOUNDED || g->first == UNBOUNDED);
+			std::set< std::pair<double, int> >::iterator it = g->second.begin();
+			if (!unbounded){
+				double tallest = (g->first == FLAT ? 0.0 : std::ldexp(1.0, g->first + 1));
+				it = g->second.lower_bound(std::make_pair(low[i] - tallest, -1));
+			}
+			for (; it != g->second.end() && (unbounded || it->first <= high[i]); ++it){
+				int j = it->second;
+				if (!unbounded && high[j] < low[i])
+					continue;
+				int segment = (side == 0 ? i : j), query = (side == 0 ? j : i) - count;
+				if (intersectsAt(segment, queries[query]))
+					found[query].push_back(segment);
+			}
+		}
+		active[side][group[i]].insert(std::make_pair(low[i], i));
+		ends[side].push(std::make_pair(right[i], i));
+	}
+	for (int k = 0; k < q; k++)
+		std::sort(found[k].begin(), found[k].end());
+
+	delete[] left;
+	delete[] right;
+	delete[] low;
+	delete[] high;
+	delete[] group;
+	delete[] order;
+	return found;
+}
+
+/**
+ *  Method that counts the line segments that intersect with a given
+ *  LineSegment, without listing them.
+ *
+ *  @param LS The line segment used to find the intersects.
+ *  @return lines The number of segments that intersect with LS.
+ */
+template <class DT>
+int Segments<DT>::countIntersects(LineSegment<DT>& LS){
+	int lines = 0;
+	for (int i = 0; i < count; i++){
+		if (intersectsAt(i, LS))
+			lines++;
+	}
+	return lines;
+}
+
+/**
+ *  Method that counts the pairs of intersecting line segments without
+ *  listing them.
+ *
+ *  When snap rounding is on and every segment spans the same vertical slab
+ *  a <= x <= b, two segments cross exactly when their order along x = a
+ *  differs from their order along x = b, so the count is the number of
+ *  inversions between the two orders and takes O(n log n) no matter how many
+ *  pairs intersect. The orders are taken from the grid coordinates, so this
+ *  gives the same answer as the exact test intersectsAt() uses there.
+ *  Without a grid intersectsAt() compares rounded intersection points, which
+ *  the two orders cannot reproduce, so the segments are always swept from
+ *  left to right and each one is only tested against the segments whose x
+ *  range it overlaps.
+ *
+ *  @return total The number of intersecting pairs.
+ */
+template <class DT>
+long long Segments<DT>::countAllIntersections(){
+	if (count < 2)
+		return 0;
+	double* left = new double[count];
+	double* right = new double[count];
+	double* leftY = new double[count];
+	double* rightY = new double[count];
+	bool slab = grid > 0;
+	for (int i = 0; i < count; i++){
+		double x1, y1, x2, y2;
+		if (grid > 0){
+			//Grid coordinates fit in a double exactly.
+			x1 = gridPoints[4*i];
+			y1 = gridPoints[4*i+1];
+			x2 = gridPoints[4*i+2];
+			y2 = gridPoints[4*i+3];
+		} else {
+			x1 = segments[i].getP1().getXValue();
+			y1 = segments[i].getP1().getYValue();
+			x2 = segments[i].getP2().getXValue();
+			y2 = segments[i].getP2().getYValue();
+		}
+		if (x2 < x1){
+			std::swap(x1, x2);
+			std::swap(y1, y2);
+		}
+		left[i] = x1;
+		right[i] = x2;
+		leftY[i] = y1;
+		rightY[i] = y2;
+		if (left[i] == right[i] || left[i] != left[0] || right[i] != right[0])
+			slab = false;
+	}
+
+	int* order = new int[count];
+	for (int i = 0; i < count; i++)
+		order[i] = i;
+	long long total = 0;
+	if (slab){
+		//Ties along x = a are broken so that a pair sharing a point there counts.
+		std::sort(order, order + count, [&](int i, int j){
+			if (leftY[i] != leftY[j])
+				return leftY[i] < leftY[j];
+			return rightY[i] > rightY[j];
+		});
+		double* values = new double[count];
+		double* buffer = new double[count];
+		for (int i = 0; i < count; i++)
+			values[i] = rightY[order[i]];
+		total = countInversions(values, buffer, 0, count);
+		//Segments on the same line are parallel, not intersecting.
+		for (int i = 0; i < count;){
+			int j = i;
+			while (j < count && leftY[order[j]] == leftY[order[i]] && rightY[order[j]] == rightY[order[i]])
+				j++;
+			total -= (long long)(j - i) * (j - i - 1) / 2;
+			i = j;
+		}
+		delete[] values;
+		delete[] buffer;
+	} else {
+		std::sort(order, order + count, [&](int i, int j){
+			return left[i] < left[j];
+		});
+		std::vector<int> active;
+		for (int k = 0; k < count; k++){
+			int i = order[k];
+			for (int a = 0; a < (int)active.size();){
+				int j = active[a];
+				if (right[j] < left[i]){
+					active[a] = active.back();
+					active.pop_back();
+					continue;
+				}
+				if (intersectsAt(i, segments[j]))
+					total++;
+				a++;
+			}
+			active.push_back(i);
+		}
+	}
+
+	delete[] left;
+	delete[] right;
+	delete[] leftY;
+	delete[] rightY;
+	delete[] order;
+	return total;
+}
+
+/**
+ *  Method that turns on snap rounding. Every end point is moved to the
+ *  nearest point of a grid once, here and in addLineSegment(), and the grid
+ *  coordinates are kept so intersection tests can use exact integer
+ *  arithmetic instead of comparing rounded slopes and intercepts.
+ *
+ *  @param size The distance between two grid points, e.g. 0.01.
+ */
+template <class DT>
+void Segments<DT>::snapRound(double size){
+	if (size <= 0)
+		throw SegmentsException();
+	long long* snapped = new long long[4 * maxSize];
+	try{
+		for (int i = 0; i < count; i++){
+			snapped[4*i] = snapToGrid(segments[i].getP1().getXValue(), size);
+			snapped[4*i+1] = snapToGrid(segments[i].getP1().getYValue(), size);
+			snapped[4*i+2] = snapToGrid(segments[i].getP2().getXValue(), size);
+			snapped[4*i+3] = snapToGrid(segments[i].getP2().getYValue(), size);
+		}
+	}
+	catch (SegmentsException &e) {
+		delete[] snapped;
+		throw;
+	}
+	delete[] gridPoints;
+	gridPoints = snapped;
+	grid = size;
+	for (int i = 0; i < count; i++){
+		segments[i] = LineSegment<DT>(Point<DT>(gridPoints[4*i] * grid, gridPoints[4*i+1] * grid),
+				Point<DT>(gridPoints[4*i+2] * grid, gridPoints[4*i+3] * grid));
+	}
+}
+
+/**
+ *  Method that snaps a line segment to the grid, if snap rounding is on.
+ *
+ *  @param L The line segment to snap.
+ *  @return The snapped line segment, or L if snap rounding is off.
+ */
+template <class DT>
+LineSegment<DT> Segments<DT>::snapSegment(LineSegment<DT> L){
+	if (grid <= 0)
+		return L;
+	Point<DT> one = Point<DT>(snapToGrid(L.getP1().getXValue(), grid) * grid, snapToGrid(L.getP1().getYValue(), grid) * grid);
+	Point<DT> two = Point<DT>(snapToGrid(L.getP2().getXValue(), grid) * grid, snapToGrid(L.getP2().getYValue(), grid) * grid);
+	return LineSegment<DT>(one, two);
+}
+
+/**
+ *  Method that determines whether a stored line segment intersects with a
+ *  given LineSegment, exactly on the grid when snap rounding is on.
+ *
+ *  @param index The index of the stored line segment.
+ *  @param L The line segment being compared.
+ *  @return Whether the two segments intersect.
+ */
+template <class DT>
+bool Segments<DT>::intersectsAt(int index, LineSegment<DT>& L){
+	if (grid > 0){
+		long long other[4] = {snapToGrid(L.getP1().getXValue(), grid), snapToGrid(L.getP1().getYValue(), grid),
+				snapToGrid(L.getP2().getXValue(), grid), snapToGrid(L.getP2().getYValue(), grid)};
+		return gridIntersects(gridPoints + 4 * index, other);
+	}
+	return segments[index].isParallel(L) == false && segments[index].itIntersects(L) == true;
+}
+
+/**
+ *  Method that finds where a stored line segment meets a given LineSegment.
+ *  When snap rounding is on the point is worked out from the grid
+ *  coordinates, which also works for vertical segments.
+ *
+ *  @param index The index of the stored line segment.
+ *  @param L The line segment that is being used.
+ *  @return The point at which the two segments intersect.
+ */
+template <class DT>
+Point<DT> Segments<DT>::intersectionPointAt(int index, LineSegment<DT>& L){
+	if (grid <= 0)
+		return segments[index].intersectionPoint(L);
+	long long* A = gridPoints + 4 * index;
+	long long B[4] = {snapToGrid(L.getP1().getXValue(), grid), snapToGrid(L.getP1().getYValue(), grid),
+			snapToGrid(L.getP2().getXValue(), grid), snapToGrid(L.getP2().getYValue(), grid)};
+	long long ax = A[2] - A[0], ay = A[3] - A[1];
+	long long bx = B[2] - B[0], by = B[3] - B[1];
+	double t = (double)((B[0] - A[0]) * by - (B[1] - A[1]) * bx) / (double)(ax * by - ay * bx);
+	return Point<DT>((A[0] + t * ax) * grid, (A[1] + t * ay) * grid);
+}
+
+/**
+ *  Method that returns the grid used for snap rounding.
+ *
+ *  @return grid The distance between two grid points, or 0 if snap rounding
+ *  	is off.
+ */
+template <class DT>
+double Segments<DT>::getGrid(){
+	return grid;
+}
+
+/**
+ * 	Method that finds the two closest line segments that do not touch. The
+ * 	segments are swept along their main direction (the sweep turns the
+ * 	plane so long, nearly parallel segments lie close to flat) while the
+ * 	best distance so far, best, is kept. Segments ending more than best
+ * 	behind the sweep are dropped. The rest are grouped by how tall they are
+ * 	and kept ordered by their lowest value across the sweep, so each new
+ * 	segment is only compared with segments whose own extent comes within
+ * 	best of its own, instead of with everything below the tallest segment.
+ * 	For sets of short or nearly parallel segments this takes about
+ * 	O(n log n).
+ *
+ * 	@param first, second Receive the indices of the closest pair.
+ * 	@return best The exact distance between the two segments, rather than
+ * 	the approximation squareroot() gives.
+ */
+template <class DT>
+double Segments<DT>::closestPair(int& first, int& second){
+	//Weighting the doubled angles by squared length finds the direction the
+	//long segments share, since those are the ones that stay active longest.
+	double sumCos = 0, sumSin = 0, largest = 0;
+	for (int i = 0; i < count; i++){
+		double dx = segments[i].getP2().getXValue() - segments[i].getP1().getXValue();
+		double dy = segments[i].getP2().getYValue() - segments[i].getP1().getYValue();
+		sumCos += dx * dx - dy * dy;
+		sumSin += 2 * dx * dy;
+		double values[4] = {segments[i].getP1().getXValue(), segments[i].getP1().getYValue(),
+				segments[i].getP2().getXValue(), segments[i].getP2().getYValue()};
+		for (int v = 0; v < 4; v++)
+			largest = std::max(largest, std::fabs(values[v]));
+	}
+	double angle = std::atan2(sumSin, sumCos) / 2;
+	double c = std::cos(angle), s = std::sin(angle);
+
+	double* left = new double[count + 1];
+	double* right = new double[count + 1];
+	double* low = new double[count + 1];
+	double* high = new double[count + 1];
+	int* group = new int[count + 1];
+	int* order = new int[count + 1];
+	for (int i = 0; i < count; i++){
+		double x1 = segments[i].getP1().getXValue(), y1 = segments[i].getP1().getYValue();
+		double x2 = segments[i].getP2().getXValue(), y2 = segments[i].getP2().getYValue();
+		double u1 = x1 * c + y1 * s, v1 = y1 * c - x1 * s;
+		double u2 = x2 * c + y2 * s, v2 = y2 * c - x2 * s;
+		left[i] = (u1 < u2 ? u1 : u2);
+		right[i] = (u1 > u2 ? u1 : u2);
+		low[i] = (v1 < v2 ? v1 : v2);
+		high[i] = (v1 > v2 ? v1 : v2);
+		//Segments in group g are less than 2^(g+1) tall; flat ones get their own.
+		group[i] = (high[i] > low[i] ? std::ilogb(high[i] - low[i]) : -2000);
+		order[i] = i;
+	}
+	std::sort(order, order + count, [&](int i, int j){
+		return left[i] < left[j];
+	});
+
+	double bestSquared = -1, best = 1.79769e+308;
+	//Pruning leaves room for rounding in the distances and the turned plane.
+	double slack = 1e-9 + largest * 1e-12;
+	std::map< int, std::set< std::pair<double, int> > > active;
+	std::priority_queue< std::pair<double, int>, std::vector< std::pair<double, int> >, std::greater< std::pair<double, int> > > ends;
+	first = -1;
+	second = -1;
+	for (int k = 0; k < count; k++){
+		int i = order[k];
+		while (!ends.empty() && ends.top().first < left[i] - best - slack){
+			int j = ends.top().second;
+			active[group[j]].erase(std::make_pair(low[j], j));
+			if (active[group[j]].empty())
+				active.erase(group[j]);
+			ends.pop();
+		}
+		for (typename std::map< int, std::set< std::pair<double, int> > >::iterator g = active.begin(); g != active.end(); ++g){
+			double tallest = (g->first == -2000 ? 0.0 : std::ldexp(1.0, g->first + 1));
+			std::set< std::pair<double, int> >::iterator it = g->second.lower_bound(std::make_pair(low[i] - best - slack - tallest, -1));
+			for (; it != g->second.end() && it->first <= high[i] + best + slack; ++it){
+				int j = it->second;
+				if (high[j] < low[i] - best - slack)
+					continue;
+				double squared = segmentDistanceSquared(segments[i], segments[j]);
+				if (squared == 0)
+					continue;
+				int a = (i < j ? i : j), b = (i < j ? j : i);
+				if (bestSquared < 0 || squared < bestSquared || (squared == bestSquared && (a < first || (a == first && b < second)))){
+					bestSquared = squared;
+					best = std::sqrt(squared);
+					first = a;
+					second = b;
+				}
+			}
+		}
+		active[group[i]].insert(std::make_pair(low[i], i));
+		ends.push(std::make_pair(right[i], i));
+	}
+
+	delete[] left;
+	delete[] right;
+	delete[] low;
+	delete[] high;
+	delete[] group;
+	delete[] order;
+	if (first < 0)
+		throw SegmentsException();
+	return best;
+}
+
+/**
+ * 	Method that makes room for at least size line segments, keeping the
+ * 	segments already added.
+ *
+ * 	@param size The number of segments the array should be able to hold.
+ */
+template <class DT>
+void Segments<DT>::reserve(int size){
+	if (size <= maxSize)
+		return;
+	LineSegment<DT>* grown = new LineSegment<DT> [size];
+	for (int i = 0; i < count; i++)
+		grown[i] = segments[i];
+	if (gridPoints != NULL){
+		long long* grownPoints = new long long[4 * size];
+		for (int i = 0; i < 4 * count; i++)
+			grownPoints[i] = gridPoints[i];
+		delete[] gridPoints;
+		gridPoints = grownPoints;
+	}
+	delete[] segments;
+	segments = grown;
+	maxSize = size;
+}
+
+/**
+ * 	Method that adds several line segments at once, growing the array if
+ * 	they do not fit. If snap rounding is on, every end point is checked
+ * 	against the grid first, so either all of the segments are added or none.
+ *
+ * 	@param coordinates The end points of the segments, four values
+ * 		{x1, y1, x2, y2} per segment.
+ * 	@param n The number of segments.
+ * 	@return The number of segments added.
+ */
+template <class DT>
+int Segments<DT>::addLineSegments(const double* coordinates, int n){
+	if (grid > 0){
+		for (int i = 0; i < 4 * n; i++)
+			snapToGrid(coordinates[i], grid);
+	}
+	reserve(count + n);
+	for (int i = 0; i < n; i++){
+		const double* P = coordinates + 4 * i;
+		addLineSegment(LineSegment<DT>(Point<DT>(P[0], P[1]), Point<DT>(P[2], P[3])));
+	}
+	return n;
+}
+
+/**
+ * 	Method that finds all lines that intersect with each of several given
+ * 	segments and writes the results into arrays owned by the caller. The
+ * 	indices for query k are indices[offsets[k]] to indices[offsets[k+1]-1].
+ *
+ * 	@param queries The end points of the queries, four values {x1, y1, x2, y2}
+ * 		per query.
+ * 	@param q The number of queries.
+ * 	@param offsets An array of q+1 values that receives where each query's
+ * 		results start.
+ * 	@param indices An array that receives the indices of the intersecting
+ * 		segments.
+ * 	@param capacity The length of indices; results past it are left out.
+ * 	@return total The number of indices found, which may be more than
+ * 		capacity.
+ */
+template <class DT>
+long long Segments<DT>::findAllIntersects(const double* queries, int q, int* offsets, int* indices, long long capacity){
+	std::vector< LineSegment<DT> > lines;
+	for (int k = 0; k < q; k++){
+		const double* P = queries + 4 * k;
+		lines.push_back(LineSegment<DT>(Point<DT>(P[0], P[1]), Point<DT>(P[2], P[3])));
+	}
+	std::vector< std::vector<int> > found = findAllIntersects(lines.data(), q);
+	long long total = 0;
+	for (int k = 0; k < q; k++){
+		offsets[k] = (total < capacity ? total : capacity);
+		for (int i = 0; i < (int)found[k].size(); i++){
+			if (total < capacity)
+				indices[total] = found[k][i];
+			total++;
+		}
+	}
+	offsets[q] = (total < capacity ? total : capacity);
+	return total;
+}
+
+/**
+ * 	Method that finds the index of the closest line segment to each of
+ * 	several points. The points are split between several threads.
+ *
+ * 	@param points The points, two values {x, y} per point.
+ * 	@param n The number of points.
+ * 	@param indices An array of n values that receives the closest index to
+ * 		each point.
+ */
+template <class DT>
+void Segments<DT>::findClosestIndices(const double* points, int n, int* indices){
+	int threads = std::thread::hardware_concurrency();
+	if (threads < 1)
+		threads = 1;
+	if (threads > n)
+		threads = (n > 0 ? n : 1);
+	std::vector<std::thread> workers;
+	for (int t = 0; t < threads; t++){
+		workers.push_back(std::thread([&, t](){
+			for (int i = (long long)n * t / threads; i < (long long)n * (t + 1) / threads; i++){
+				Point<DT> aPoint = Point<DT>(points[2*i], points[2*i+1]);
+				indices[i] = findClosestIndex(aPoint);
+			}
+		}));
+	}
+	for (int t = 0; t < threads; t++)
+		workers[t].join();
+}
+
+/**
+ * 	Method that returns the size of the array.
+ *
+ * 	@return maxSize The maximum size of segments.
+ */
+template <class DT>
+int Segments<DT>::getSize(){
+	return maxSize;
+}
+
+/**
+ * 	Method that returns the number of line segments added so far.
+ *
+ * 	@return count The number of segments in the array.
+ */
+template <class DT>
+int Segments<DT>::getCount(){
+	return count;
+}
+
+/**
+ * 	Method that returns a specific line segment at a given index.
+ *
+ * 	@param index The chosen index of the line segment requested.
+ * 	@return segment The line segment at the specified index.
+ */
+template <class DT>
+LineSegment<DT> Segments<DT>::getSegmentAt(int index){
+	LineSegment<DT> segment = (segments[index]);
+	return segment;
+}
+
+} /* namespace geometry */
+
+#endif /* SEGMENTS_H_ */
@@ -0,0 +1,74 @@
+/*
+ * segments_c.cpp: The C interface declared in segments_c.h. Each function
+ *  forwards to a Segments<double> object and turns any exception into a
+ *  return value of -1, since exceptions cannot cross into C code.
+ */
+
+#include "segments_c.h"
+#include "segments.h"
+
+/**
+ *  Struct behind the opaque SegmentsHandle type.
+ */
+struct SegmentsHandle {
+	geometry::Segments<double> segments;
+	SegmentsHandle(int capacity) : segments(capacity) {}
+};
+
+SegmentsHandle* segments_create(int capacity){
+	try{
+		return new SegmentsHandle(capacity > 0 ? capacity : 1);
+	}
+	catch (...) {
+		return NULL;
+	}
+}
+
+void segments_destroy(SegmentsHandle* handle){
+	delete handle;
+}
+
+int segments_add(SegmentsHandle* handle, const double* coordinates, int n){
+	try{
+		return handle->segments.addLineSegments(coordinates, n);
+	}
+	catch (...) {
+		return -1;
+	}
+}
+
+long long segments_intersect(SegmentsHandle* handle, const double* queries, int q,
+		int* offsets, int* indices, long long capacity){
+	try{
+		return handle->segments.findAllIntersects(queries, q, offsets, indices, capacity);
+	}
+	catch (...) {
+		return -1;
+	}
+}
+
+int segments_nearest(SegmentsHandle* handle, const double* points, int n, int* indices){
+	try{
+		if (handle->segments.getCount() == 0)
+			return -1;
+		handle->segments.findClosestIndices(points, n, indices);
+		return 0;
+	}
+	catch (...) {
+		return -1;
+	}
+}
+
+int segments_snap(SegmentsHandle* handle, double grid){
+	try{
+		handle->segments.snapRound(grid);
+		return 0;
+	}
+	catch (...) {
+		return -1;
+	}
+}
+
+int segments_count(SegmentsHandle* handle){
+	return handle->segments.getCount();
+}
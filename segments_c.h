@@ -0,0 +1,72 @@
+/*
+ * segments_c.h: A C interface to the Segments class, so programs written in
+ *  C (or any language that can call C) can add, intersect and search line
+ *  segments in batches. Every batch call reads from and writes to arrays
+ *  owned by the caller. Functions that can fail return -1.
+ */
+
+#ifndef SEGMENTS_C_H_
+#define SEGMENTS_C_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  Opaque handle to a set of line segments.
+ */
+typedef struct SegmentsHandle SegmentsHandle;
+
+/**
+ *  Creates an empty set of line segments with room for capacity segments.
+ *  The set grows when more are added. Returns NULL on failure.
+ */
+SegmentsHandle* segments_create(int capacity);
+
+/**
+ *  Frees a set of line segments.
+ */
+void segments_destroy(SegmentsHandle* handle);
+
+/**
+ *  Adds n line segments, given as four values {x1, y1, x2, y2} each.
+ *  Returns the number of segments added, or -1 if any of them lies outside
+ *  the snap grid, in which case none are added.
+ */
+int segments_add(SegmentsHandle* handle, const double* coordinates, int n);
+
+/**
+ *  Finds the segments intersecting each of q query segments, given as four
+ *  values {x1, y1, x2, y2} each. The indices for query k are written to
+ *  indices[offsets[k]] up to indices[offsets[k+1]-1], so offsets must hold
+ *  q+1 values. Returns the number of indices found; if that is more than
+ *  capacity, the results were cut off and the call should be repeated with
+ *  a larger indices array.
+ */
+long long segments_intersect(SegmentsHandle* handle, const double* queries, int q,
+		int* offsets, int* indices, long long capacity);
+
+/**
+ *  Finds the index of the closest segment to each of n points, given as two
+ *  values {x, y} each, and writes them to indices. Returns 0, or -1 when the
+ *  set holds no segments.
+ */
+int segments_nearest(SegmentsHandle* handle, const double* points, int n, int* indices);
+
+/**
+ *  Snaps every segment, now and later, to a grid with the given spacing.
+ *  Returns 0, or -1 if the spacing is not positive or a segment lies outside
+ *  the grid, in which case nothing is changed.
+ */
+int segments_snap(SegmentsHandle* handle, double grid);
+
+/**
+ *  Returns the number of segments in the set.
+ */
+int segments_count(SegmentsHandle* handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SEGMENTS_C_H_ */